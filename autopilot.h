@@ -0,0 +1,147 @@
+// === Autopilot ===
+// Picks a direction for the snake each tick, for the AI player in the front
+// ends and as a load generator for snakeBench.
+//
+// decide() runs a breadth-first search from the head to the fruit over the
+// wrap-around board. Body cells count as open from the step on which they
+// will have moved away, so the snake can follow its own tail. The fruit path
+// is only taken if, after the snake has followed it and grown, the head can
+// still reach the new tail. Otherwise the autopilot chases its tail: it
+// takes the move from which the tail is reachable and farthest away, or if
+// there is none, the move with the most room.
+//
+// All search buffers are sized once per board and reused, and "visited" is
+// a stamp per cell so nothing is cleared between searches. A decision costs
+// a few BFS passes over the board and allocates nothing.
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include <algorithm>
+#include <vector>
+#include "snakeEngine.h"
+
+class Autopilot {
+    static const int Fruit = -2; // search goal: any fruit cell
+
+    int cells = 0;
+    std::vector<int> queue, from, dist, freeAt;
+    std::vector<int> body, moved; // current and simulated snake, head first
+    std::vector<unsigned> seen, marked;
+    unsigned seenStamp = 0, markStamp = 0;
+    int visited = 0; // cells reached by the last search
+
+    void resize(int n) {
+        if (n == cells) return;
+        cells = n;
+        queue.resize(n);
+        from.resize(n);
+        dist.resize(n);
+        freeAt.resize(n);
+        body.resize(n + 1);
+        moved.resize(n + 1);
+        seen.assign(n, 0);
+        marked.assign(n, 0);
+        seenStamp = markStamp = 0;
+    }
+
+    static unsigned bump(unsigned& stamp, std::vector<unsigned>& marks) {
+        if (++stamp == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            stamp = 1;
+        }
+        return stamp;
+    }
+
+    // Segment i of an n long snake (0 = head) can be entered from step
+    // n - i + 1 on: the engine checks the body before the tail moves.
+    void markBody(const int* segs, int n) {
+        bump(markStamp, marked);
+        for (int i = 0; i < n; i++) {
+            marked[segs[i]] = markStamp;
+            freeAt[segs[i]] = n - i + 1;
+        }
+    }
+
+    bool open(const Occupancy& o, int cell, int step) const {
+        return !o.isWall(cell) && (marked[cell] != markStamp || step >= freeAt[cell]);
+    }
+
+    // BFS from start, which is reached at startStep. Returns the goal cell
+    // (a cell, or Fruit for any fruit) or -1 if it cannot be reached.
+    template <class B>
+    int search(const B& board, const Occupancy& o, int start, int startStep, int goal) {
+        bump(seenStamp, seen);
+        int qh = 0, qt = 0;
+        queue[qt++] = start;
+        seen[start] = seenStamp;
+        dist[start] = startStep;
+        from[start] = -1;
+        visited = 1;
+        while (qh < qt) {
+            int c = queue[qh++];
+            for (int d = 0; d < 4; d++) {
+                int n = board.next(c, d);
+                if (seen[n] == seenStamp || !open(o, n, dist[c] + 1)) continue;
+                seen[n] = seenStamp;
+                dist[n] = dist[c] + 1;
+                from[n] = c;
+                visited++;
+                if (n == goal || (goal == Fruit && o.isFruit(n))) return n;
+                queue[qt++] = n;
+            }
+        }
+        return -1;
+    }
+
+    template <class B>
+    static char towards(const B& board, int from, int to) {
+        const char dirs[4] = {'w', 'a', 's', 'd'};
+        for (int d = 0; d < 4; d++)
+            if (board.next(from, d) == to) return dirs[d];
+        return 'w';
+    }
+
+public:
+    template <class B>
+    char decide(const BasicEngine<B>& game) {
+        const B& board = game.board;
+        const Occupancy& o = game.arena.getOccupancy();
+        const Snake& snake = game.snake;
+        resize(board.cells());
+        int n = snake.size();
+        for (int i = 0; i < n; i++) body[i] = snake.segment(i);
+        int head = body[0], tail = body[n - 1];
+        markBody(body.data(), n);
+
+        int fruit = search(board, o, head, 0, Fruit);
+        if (fruit >= 0) {
+            // Snake after following the path and eating: the path from the
+            // fruit back to the head, then the old body, n + 1 cells in all.
+            int first = fruit;
+            while (from[first] != head) first = from[first];
+            int m = 0;
+            for (int c = fruit; c != head && m <= n; c = from[c]) moved[m++] = c;
+            for (int i = 0; m <= n; i++) moved[m++] = body[i];
+            markBody(moved.data(), n + 1);
+            if (search(board, o, moved[0], 0, moved[n]) >= 0) return towards(board, head, first);
+            markBody(body.data(), n);
+        }
+
+        // Survival: prefer moves that keep the tail in reach, farthest first.
+        char best = snake.checkDir();
+        long long bestScore = -1;
+        const char dirs[4] = {'w', 'a', 's', 'd'};
+        for (int d = 0; d < 4; d++) {
+            int c = board.next(head, d);
+            if (!open(o, c, 1)) continue;
+            long long score = search(board, o, c, 1, tail) >= 0 ? (1LL << 40) + dist[tail] : visited;
+            if (score > bestScore) {
+                bestScore = score;
+                best = dirs[d];
+            }
+        }
+        return best;
+    }
+};
+
+#endif
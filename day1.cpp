@@ -5,205 +5,165 @@
 #include <fstream>
 #include <random>
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "snakeEngine.h"
+#include "inputQueue.h"
+#include "scoreWriter.h"
+#include "replay.h"
+#include "hamiltonCycle.h"
+#include "mctsBot.h"
+#include "sharedState.h"
+#include "frameStats.h"
+#include "traceEvents.h"
+#include <memory>
+#include <filesystem>
+#include <ctime>
 using namespace std;
 
 // === Game Classes ===
 
-class Fruit {
-    vector<int> position;
-public:
-    int fruitType;
-    Fruit(int x = 9, int y = 9, int type = 1) : position({x, y}), fruitType(type) {}
-    vector<int> getPos() const { return position; }
-    void changeFruitPos(const vector<vector<int>>& snake) {
-        random_device rd; mt19937 gen(rd());
-        uniform_int_distribution<int> dist(0, 19);
-        vector<int> oldPos = position;
-        while (true) {
-            position[0] = dist(gen);
-            position[1] = dist(gen);
-            bool valid = true;
-            for (const auto& seg : snake) {
-                if (seg == position || position == oldPos) {
-                    valid = false;
-                    break;
-                }
-            }
-            if (valid) break;
-        }
-    }
-    void setFruitType(int type) { fruitType = type; }
-    int getFruitType() const { return fruitType; }
-};
-
-class Score {
-    int score;
-public:
-    Score() : score(0) {}
-    Score operator++(int) { score++; return *this; }
-    Score operator+=(int value) { score += value; return *this; }
-    int getScore() const { return score; }
-};
-
-class Block {
-    vector<int> position;
-public:
-    Block(int x, int y) : position({x, y}) {}
-    bool checkIfHit(vector<int> pos) const { return position == pos; }
-    vector<int> getPosition() const { return position; }
-};
-
-class Snake {
-public:
-    vector<vector<int>> snake;
-    char dir;
-    Snake() {
-        for (int i = 0; i < 3; i++)
-            snake.push_back({9, 3 + i});
-        dir = 'w';
-    }
-    char checkDir() const { return dir; }
-    vector<int> checkHead() { return snake[0]; }
-    void increaseSnakeSize() { snake.push_back(snake.back()); }
-    char move(char position, Fruit& f, Score& s, const vector<Block>& b) {
-        int prevX = snake[0][0], prevY = snake[0][1];
-        switch (position) {
-            case 'w': snake[0][1]--; break;
-            case 's': snake[0][1]++; break;
-            case 'd': snake[0][0]++; break;
-            case 'a': snake[0][0]--; break;
-        }
-
-        if (snake[0][1] >= 20) snake[0][1] = 0;
-        else if (snake[0][1] < 0) snake[0][1] = 19;
-        if (snake[0][0] >= 20) snake[0][0] = 0;
-        else if (snake[0][0] < 0) snake[0][0] = 19;
-
-        for (const auto& block : b)
-            if (block.checkIfHit(snake[0])) return 'b';
-
-        for (size_t i = 1; i < snake.size(); i++)
-            if (snake[0] == snake[i]) return 's';
-
-        dir = position;
-
-        if (f.getPos() == snake[0]) {
-            increaseSnakeSize();
-            f.changeFruitPos(snake);
-            s++;
-        }
-
-        for (size_t i = 1; i < snake.size(); i++) {
-            swap(prevX, snake[i][0]);
-            swap(prevY, snake[i][1]);
-        }
-
-        return 'G';
+// SFML front end: the engine holds the rules, this class only draws them.
+// Walls never change during a game, so they are baked once into an off-screen
+// texture and drawn as one sprite. Fruit and snake are one vertex array of
+// quads, updated in place each frame and drawn with a single call.
+// Rendering runs at display rate between ticks: each segment slides from the
+// cell it held on the previous tick to its current one.
+class GameSFML : public Engine {
+    sf::VertexArray cells;
+    sf::RenderTexture arenaLayer;
+    sf::Sprite arenaSprite;
+    float bakedCellSize = 0;
+    int prevTail = -1;  // tail cell before the last tick
+    bool moved = false; // whether the last tick moved the snake
+    void setQuad(sf::VertexArray& va, size_t q, float x, float y, sf::Color color) {
+        sf::Vertex* v = &va[q * 4];
+        float left = x * cellSize, top = y * cellSize;
+        v[0].position = sf::Vector2f(left, top);
+        v[1].position = sf::Vector2f(left + cellSize, top);
+        v[2].position = sf::Vector2f(left + cellSize, top + cellSize);
+        v[3].position = sf::Vector2f(left, top + cellSize);
+        for (int k = 0; k < 4; k++) v[k].color = color;
     }
-};
-
-class Arena {
-protected:
-    vector<Block> blocks;
-public:
-    virtual ~Arena() {}
-    virtual void resetArena() { blocks.clear(); }
-    vector<Block>& getBlocks() { return blocks; }
-};
-
-class Classic : public Arena {
-public:
-    Classic() { resetArena(); }
-};
-
-class Complex : public Arena {
-public:
-    Complex() {
-        resetArena();
-        for (int i = 0; i < 20; i++) {
-            blocks.push_back(Block(0, i));
-            blocks.push_back(Block(19, i));
-        }
-        for (int i = 1; i < 19; i++) {
-            blocks.push_back(Block(i, 0));
-            blocks.push_back(Block(i, 19));
+    void bakeArena() {
+        TRACE_SPAN("bake arena");
+        bakedCellSize = cellSize;
+        if (arena.getBlocks().empty()) return;
+        sf::VertexArray blocks(sf::Quads, arena.getBlocks().size() * 4);
+        size_t q = 0;
+        for (auto& block : arena.getBlocks()) {
+            auto pos = block.getPosition();
+            setQuad(blocks, q++, pos[0], pos[1], sf::Color::Blue);
         }
+        arenaLayer.create(width() * cellSize + 0.5f, height() * cellSize + 0.5f);
+        arenaLayer.clear(sf::Color::Transparent);
+        arenaLayer.draw(blocks);
+        arenaLayer.display();
+        arenaSprite.setTexture(arenaLayer.getTexture(), true);
     }
-};
-
-class Boundary : public Arena {
 public:
-    Boundary() {
-        resetArena();
-        for (int i = 4; i < 8; i++)
-            for (int j = 4; j < 8; j++)
-                blocks.push_back(Block(i, j));
-        for (int i = 4; i < 8; i++)
-            for (int j = 12; j < 16; j++)
-                blocks.push_back(Block(i, j));
-        for (int i = 12; i < 16; i++)
-            for (int j = 4; j < 8; j++)
-                blocks.push_back(Block(i, j));
-        for (int i = 12; i < 16; i++)
-            for (int j = 12; j < 16; j++)
-                blocks.push_back(Block(i, j));
-    }
-};
-
-class GameSFML {
-public:
-    Arena* arena;
-    Snake snake;
-    Fruit fruit;
-    Score score;
     float cellSize;
     bool gameOver = false;
-    GameSFML(Arena* a, float cell) : arena(a), cellSize(cell) {}
+    GameSFML(Arena* a, float cell, unsigned seed) : Engine(*a, seed), cells(sf::Quads), cellSize(cell) { bakeArena(); }
     char update(char dir) {
-        return snake.move(dir, fruit, score, arena->getBlocks());
+        int len = snake.size();
+        int tail = snake.segment(len - 1);
+        char result = step(dir);
+        moved = result == 'G' || result == 'W';
+        prevTail = snake.size() > len ? snake.segment(snake.size() - 1) : tail;
+        return result;
     }
-    void render(sf::RenderWindow& window, sf::Text& scoreText, int snakeStyle) {
+    // alpha is how far we are from the previous tick to the current one (0..1).
+    void render(sf::RenderWindow& window, sf::Text& scoreText, int snakeStyle, float alpha = 1.f) {
+        TRACE_SPAN("render");
         window.clear(sf::Color::Black);
 
-        sf::RectangleShape fruitRect(sf::Vector2f(cellSize, cellSize));
-        switch (fruit.getFruitType()) {
-            case 1: fruitRect.setFillColor(sf::Color::Red); break;
-            case 2: fruitRect.setFillColor(sf::Color::Green); break;
-            case 3: fruitRect.setFillColor(sf::Color::Yellow); break;
-            case 4: fruitRect.setFillColor(sf::Color::Magenta); break;
-            case 5: fruitRect.setFillColor(sf::Color::Cyan); break;
+        if (cellSize != bakedCellSize) bakeArena();
+        if (!arena.getBlocks().empty()) {
+            TRACE_SPAN("arena layer");
+            window.draw(arenaSprite);
         }
-        auto fpos = fruit.getPos();
-        fruitRect.setPosition(fpos[0] * cellSize, fpos[1] * cellSize);
-        window.draw(fruitRect);
 
-        for (size_t i = 0; i < snake.snake.size(); ++i) {
-            sf::RectangleShape seg(sf::Vector2f(cellSize, cellSize));
+        {
+            TRACE_SPAN("snake layer");
+            size_t quads = 1 + snake.size();
+            if (cells.getVertexCount() != quads * 4) cells.resize(quads * 4);
+
+            sf::Color fruitColor = sf::Color::White;
+            switch (fruit.getFruitType()) {
+                case 1: fruitColor = sf::Color::Red; break;
+                case 2: fruitColor = sf::Color::Green; break;
+                case 3: fruitColor = sf::Color::Yellow; break;
+                case 4: fruitColor = sf::Color::Magenta; break;
+                case 5: fruitColor = sf::Color::Cyan; break;
+            }
+            auto fpos = fruit.getPos();
+            setQuad(cells, 0, fpos[0], fpos[1], fruitColor);
+
+            sf::Color headColor = sf::Color::White, bodyColor = sf::Color::White;
             switch (snakeStyle) {
-                case 1: seg.setFillColor(i == 0 ? sf::Color::Green : sf::Color(0, 180, 0)); break;
-                case 2: seg.setFillColor(i == 0 ? sf::Color::Cyan : sf::Color(0, 128, 255)); break;
-                case 3: seg.setFillColor(i == 0 ? sf::Color::Yellow : sf::Color(255, 215, 0)); break;
-                case 4: seg.setFillColor(i == 0 ? sf::Color::Magenta : sf::Color(200, 0, 200)); break;
-                case 5: seg.setFillColor(i == 0 ? sf::Color::White : sf::Color(160, 160, 160)); break;
+                case 1: headColor = sf::Color::Green; bodyColor = sf::Color(0, 180, 0); break;
+                case 2: headColor = sf::Color::Cyan; bodyColor = sf::Color(0, 128, 255); break;
+                case 3: headColor = sf::Color::Yellow; bodyColor = sf::Color(255, 215, 0); break;
+                case 4: headColor = sf::Color::Magenta; bodyColor = sf::Color(200, 0, 200); break;
+                case 5: headColor = sf::Color::White; bodyColor = sf::Color(160, 160, 160); break;
+            }
+            int n = snake.size();
+            for (int i = 0; i < n; ++i) {
+                int cur = snake.segment(i);
+                int prev = !moved ? cur : i + 1 < n ? snake.segment(i + 1) : prevTail;
+                float x = cur % width(), y = cur / width();
+                float dx = x - prev % width(), dy = y - prev / width();
+                if (dx > 1) dx -= width(); else if (dx < -1) dx += width(); // wrapped across an edge
+                if (dy > 1) dy -= height(); else if (dy < -1) dy += height();
+                setQuad(cells, 1 + i, x - dx * (1 - alpha), y - dy * (1 - alpha), i == 0 ? headColor : bodyColor);
             }
-            seg.setPosition(snake.snake[i][0] * cellSize, snake.snake[i][1] * cellSize);
-            window.draw(seg);
-        }
 
-        for (auto& block : arena->getBlocks()) {
-            auto pos = block.getPosition();
-            sf::RectangleShape b(sf::Vector2f(cellSize, cellSize));
-            b.setFillColor(sf::Color::Blue);
-            b.setPosition(pos[0] * cellSize, pos[1] * cellSize);
-            window.draw(b);
+            window.draw(cells);
         }
 
+        TRACE_SPAN("score layer");
         scoreText.setString("Score: " + to_string(score.getScore()));
         window.draw(scoreText);
     }
     char getDir() const { return snake.checkDir(); }
 };
 
+// Polls W/A/S/D on its own thread (about once a millisecond) and pushes each
+// new press into the ring, so a press is seen even while the main thread is
+// waiting for vsync. Only polls while the game says it is listening.
+class KeyPoller {
+    SpscRing<char, 64>& keys;
+    atomic<bool> running{true};
+    thread worker;
+
+    void poll() {
+        const sf::Keyboard::Key codes[4] = {sf::Keyboard::W, sf::Keyboard::A, sf::Keyboard::S, sf::Keyboard::D};
+        const char turns[4] = {'w', 'a', 's', 'd'};
+        bool down[4] = {false, false, false, false};
+        while (running.load(memory_order_relaxed)) {
+            for (int k = 0; k < 4; ++k) {
+                bool pressed = listening.load(memory_order_relaxed) && sf::Keyboard::isKeyPressed(codes[k]);
+                if (pressed && !down[k]) keys.push(turns[k]);
+                down[k] = pressed;
+            }
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+
+public:
+    atomic<bool> listening{false};
+    KeyPoller(SpscRing<char, 64>& ring) : keys(ring), worker(&KeyPoller::poll, this) {}
+    ~KeyPoller() {
+        running = false;
+        worker.join();
+    }
+};
+
 // === Includes ===
 #include <SFML/Graphics.hpp>
 #include <iostream>
@@ -220,14 +180,54 @@ using namespace std;
 
 // === Main Function ===
 
-int main() {
-    const int gridSize = 20;
-    const float cellSize = 32.f;
+// Usage: snake [gridSize] [-t] [-f] [-r file] [-s name] [-p file] [-T file], board is gridSize x gridSize cells (default 20).
+// -t polls the keyboard on a separate thread instead of in the event loop.
+// -f fsyncs saved scores.
+// -r plays a recorded game back; every finished game is saved in replays/.
+// -s publishes the game in shared memory for an outside bot (snakeShmBot),
+// whose turns are then taken like key presses; games it played in are not scored.
+// -p writes frame timing percentiles to file on exit, JSON if the name ends
+// in .json, CSV otherwise. F3 shows them over the game.
+// -T writes the trace spans to file on exit as Chrome trace-event JSON, in a
+// build with -DSNAKE_TRACE (see traceEvents.h).
+// P during a game switches the autopilot on and off, H the Hamiltonian cycle
+// solver and M the tree search bot; games they played in are not scored.
+int main(int argc, char** argv) {
+    TRACE_THREAD("main");
+    int gridSize = 20;
+    bool inputThread = false, syncScores = false;
+    Replay playback;
+    bool playing = false; // showing a replay instead of taking input
+    string sharedName, statsFile, traceFile;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t")) inputThread = true;
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) sharedName = argv[++i];
+        else if (!strcmp(argv[i], "-f")) syncScores = true;
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) statsFile = argv[++i];
+        else if (!strcmp(argv[i], "-T") && i + 1 < argc) traceFile = argv[++i];
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            if (!playback.load(argv[++i]) || playback.width != playback.height) {
+                cerr << "cannot play " << argv[i] << endl;
+                return 1;
+            }
+            playing = true;
+        } else if (argv[i][0] && strspn(argv[i], "0123456789") == strlen(argv[i]))
+            gridSize = (int)max(8L, min((long)Board::maxSide, strtol(argv[i], nullptr, 10)));
+        else {
+            cerr << "unknown option " << argv[i] << endl;
+            cerr << "usage: snake [gridSize] [-t] [-f] [-r file] [-s name] [-p file] [-T file]" << endl;
+            return 1;
+        }
+    }
+    if (playing) gridSize = playback.width;
+    const float cellSize = 640.f / gridSize;
     sf::RenderWindow window(sf::VideoMode(gridSize * cellSize, gridSize * cellSize), "Snake Game", sf::Style::Close);
     int speedLevel = 2;
     int snakeStyle = 1;
     int fruitStyle = 1;
-    window.setFramerateLimit(5 + speedLevel * 3);
+    window.setVerticalSyncEnabled(true);
+    sf::Clock frameClock;
+    float lag = 0; // simulation time not yet consumed by ticks
 
     enum GameState { MENU, PLAYING, GAME_OVER, HIGH_SCORES, SPEED_SELECT, MODE_SELECT, SNAKE_STYLE_SELECT, FRUIT_STYLE_SELECT };
     GameState state = MENU;
@@ -275,35 +275,94 @@ int main() {
     fruitPrompt.setPosition(100, gridSize * cellSize / 2);
 
     int selectedMode = 1;
-    Arena* arena = new Classic();
-    GameSFML* game = new GameSFML(arena, cellSize);
-    game->fruit.setFruitType(fruitStyle);
-    char direction = 'w';
-
-    auto loadTopScores = []() {
-        ifstream file("score.txt");
-        vector<int> scores;
-        int s;
-        while (file >> s) scores.push_back(s);
-        sort(scores.begin(), scores.end(), greater<int>());
-        if (scores.size() > 5) scores.resize(5);
-        return scores;
+    random_device seeds;
+    Arena* arena = nullptr;
+    GameSFML* game = nullptr;
+    Replay recording; // the game being played, saved when it ends
+    Autopilot pilot;
+    CycleSolver solver;
+    unique_ptr<MctsBot> bot; // started the first time M is pressed
+    bool autopilot = false, solving = false, searching = false, assisted = false;
+    unique_ptr<SharedStatePublisher> shared;
+    if (!sharedName.empty()) {
+        shared.reset(new SharedStatePublisher(sharedName, gridSize, gridSize));
+        if (!shared->isOpen()) {
+            cerr << "cannot create shared memory " << sharedName << endl;
+            return 1;
+        }
+    }
+    auto newGame = [&](unsigned seed) {
+        delete game;
+        delete arena;
+        arena = new Arena(makeArena(selectedMode, gridSize, gridSize));
+        game = new GameSFML(arena, cellSize, seed);
+        game->fruit.setFruitType(fruitStyle);
+        recording = Replay();
+        recording.seed = seed;
+        recording.mode = selectedMode;
+        recording.speed = speedLevel;
+        recording.width = recording.height = gridSize;
+        solver.reset();
+        assisted = autopilot || solving || searching;
+        game->turnLog = playing ? nullptr : &recording.turns;
+        if (shared) shared->publish(*game);
     };
+    newGame(seeds());
+    char direction = 'w';
+    ReplayInput replayInput(playback);
+    if (playing) {
+        selectedMode = playback.mode;
+        speedLevel = playback.speed;
+        newGame(playback.seed);
+        state = PLAYING;
+    }
+    // Key presses go through the ring (from the event loop, or from the poller
+    // thread with -t) into the turn queue, which hands out one turn per tick.
+    SpscRing<char, 64> keys;
+    TurnQueue turns;
+    KeyPoller* poller = inputThread ? new KeyPoller(keys) : nullptr;
+
+    // Scores used to be kept as text in score.txt; bring them over the first time.
+    ScoreStore scores;
+    if (!scores.exists()) scores.importText("score.txt");
+    // Finished games are saved by the writer thread; from here on the store
+    // is only touched through it.
+    ScoreWriter scoreWriter(scores, syncScores);
+    // High-score lines are built only when the store's scores change (a game
+    // ends here, or another copy of the game wrote the file, checked on
+    // entering the screen and then once a second).
+    vector<sf::Text> scoreLines;
+    unsigned shownRevision = scores.getRevision() - 1;
+    sf::Clock scoreCheck;
+    bool checkScores = true;
+    sf::Text scoresBack("Press ESC to return", font, 20);
+    scoresBack.setPosition(180, 350);
+    scoresBack.setFillColor(sf::Color::Yellow);
+
+    // Where each frame's time goes: events, ticks, drawing, display (which
+    // includes waiting for vsync). F3 shows the last 10 s, refreshed twice
+    // a second so the numbers can be read.
+    FrameStats frameStats;
+    bool showStats = false;
+    sf::Text statsText("", font, 14);
+    statsText.setFillColor(sf::Color::Green);
+    statsText.setOutlineColor(sf::Color::Black);
+    statsText.setOutlineThickness(1);
+    statsText.setPosition(10, gridSize * cellSize - 110);
+    sf::Clock statsRefresh;
 
     while (window.isOpen()) {
+        TRACE_SPAN("frame");
+        frameStats.beginFrame();
+        float frameTime = frameClock.restart().asSeconds();
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed ||
                 (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
                 if (state != MENU) {
                     state = MENU;
-                    delete game;
-                    delete arena;
-                    if (selectedMode == 1) arena = new Classic();
-                    else if (selectedMode == 2) arena = new Boundary();
-                    else arena = new Complex();
-                    game = new GameSFML(arena, cellSize);
-                    game->fruit.setFruitType(fruitStyle);
+                    playing = false;
+                    newGame(seeds());
                     direction = 'w';
                     continue;
                 } else {
@@ -316,16 +375,16 @@ int main() {
                 for (int i = 0; i < 6; ++i) {
                     if (buttons[i].getGlobalBounds().contains(mousePos)) {
                         if (i == 0) {
-                            delete game;
-                            delete arena;
-                            if (selectedMode == 1) arena = new Classic();
-                            else if (selectedMode == 2) arena = new Complex();
-                            else arena = new Boundary();
-                            game = new GameSFML(arena, cellSize);
-                            game->fruit.setFruitType(fruitStyle);
+                            newGame(seeds());
                             direction = 'w';
+                            for (char key; keys.pop(key);) {}
+                            turns.clear();
+                            lag = 0;
                             state = PLAYING;
-                        } else if (i == 1) state = HIGH_SCORES;
+                        } else if (i == 1) {
+                            checkScores = true;
+                            state = HIGH_SCORES;
+                        }
                         else if (i == 2) state = SPEED_SELECT;
                         else if (i == 3) state = MODE_SELECT;
                         else if (i == 4) state = SNAKE_STYLE_SELECT;
@@ -337,7 +396,6 @@ int main() {
             if (state == SPEED_SELECT && event.type == sf::Event::KeyPressed) {
                 if (event.key.code >= sf::Keyboard::Num1 && event.key.code <= sf::Keyboard::Num5) {
                     speedLevel = event.key.code - sf::Keyboard::Num0;
-                    window.setFramerateLimit(5 + speedLevel * 3);
                     state = MENU;
                 }
             }
@@ -364,14 +422,36 @@ int main() {
                 }
             }
 
-            if (state == PLAYING && event.type == sf::Event::KeyPressed) {
-                char current = game->getDir();
-                if (event.key.code == sf::Keyboard::W && current != 's') direction = 'w';
-                else if (event.key.code == sf::Keyboard::S && current != 'w') direction = 's';
-                else if (event.key.code == sf::Keyboard::A && current != 'd') direction = 'a';
-                else if (event.key.code == sf::Keyboard::D && current != 'a') direction = 'd';
+            if (state == PLAYING && !poller && event.type == sf::Event::KeyPressed) {
+                if (event.key.code == sf::Keyboard::W) keys.push('w');
+                else if (event.key.code == sf::Keyboard::S) keys.push('s');
+                else if (event.key.code == sf::Keyboard::A) keys.push('a');
+                else if (event.key.code == sf::Keyboard::D) keys.push('d');
             }
+            if (state == PLAYING && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P) {
+                autopilot = !autopilot;
+                solving = searching = false;
+                assisted = assisted || autopilot;
+                turns.clear();
+            }
+            if (state == PLAYING && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H) {
+                solving = !solving;
+                if (solving) solver.reset(); // the body may be off the cycle by now
+                autopilot = searching = false;
+                assisted = assisted || solving;
+                turns.clear();
+            }
+            if (state == PLAYING && event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::M) {
+                searching = !searching;
+                autopilot = solving = false;
+                assisted = assisted || searching;
+                if (!bot) bot.reset(new MctsBot(15));
+                turns.clear();
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) showStats = !showStats;
         }
+        frameStats.lap(FrameStats::Events);
+        if (poller) poller->listening = state == PLAYING && window.hasFocus();
 
         if (state == MENU) {
             window.clear(sf::Color(30, 30, 30));
@@ -392,18 +472,42 @@ int main() {
             window.clear(sf::Color::Black);
             window.draw(fruitPrompt);
         } else if (state == PLAYING) {
-            if (!game->gameOver) {
+            // Fixed timestep: the speed level sets the tick rate, the display the frame rate.
+            const float tickTime = 1.f / (5 + speedLevel * 3);
+            lag = min(lag + frameTime, 4 * tickTime);
+            for (char key; keys.pop(key);) turns.push(key, game->getDir());
+            if (char turn = shared && !playing ? shared->turn() : 0) {
+                assisted = true;
+                turns.push(turn, game->getDir());
+            }
+            while (!game->gameOver && lag >= tickTime) {
+                lag -= tickTime;
+                if (playing) direction = replayInput.key(game->ticks);
+                else if (searching) direction = bot->decide(*game);
+                else if (solving) direction = solver.decide(*game);
+                else if (autopilot) direction = pilot.decide(*game);
+                else direction = turns.next(game->getDir());
                 char result = game->update(direction);
-                if (result == 'b' || result == 's') {
+                if (shared) shared->publish(*game);
+                if (result == 'b' || result == 's' || result == 'W') {
+                    TRACE_SPAN("game over");
                     game->gameOver = true;
-                    ofstream out("score.txt", ios::app);
-                    if (out.is_open()) {
-                        out << game->score.getScore() << endl;
-                        out.close();
+                    if (playing) {
+                        gameOverText.setString("Replay finished. Press ESC");
+                        continue;
                     }
+                    gameOverText.setString(result == 'W' ? "Board full, you win! Press ESC" : "Game Over! Press ESC to return");
+                    if (!assisted) scoreWriter.submit(game->score.getScore());
+                    recording.ticks = game->ticks;
+                    recording.score = game->score.getScore();
+                    recording.end = result;
+                    error_code ec;
+                    filesystem::create_directories("replays", ec);
+                    recording.save("replays/" + to_string(time(nullptr)) + "-" + to_string(recording.score) + ".replay");
                 }
             }
-            game->render(window, scoreText, snakeStyle);
+            frameStats.lap(FrameStats::Update);
+            game->render(window, scoreText, snakeStyle, game->gameOver ? 1.f : lag / tickTime);
             if (game->gameOver) {
                 window.draw(gameOverText);
                 state = GAME_OVER;
@@ -413,22 +517,63 @@ int main() {
             window.draw(gameOverText);
         } else if (state == HIGH_SCORES) {
             window.clear(sf::Color::Black);
-            vector<int> topScores = loadTopScores();
-            for (size_t i = 0; i < topScores.size(); ++i) {
-                sf::Text t("Score " + to_string(i + 1) + ": " + to_string(topScores[i]), font, 24);
-                t.setPosition(180, 100 + i * 40);
-                t.setFillColor(sf::Color::White);
-                window.draw(t);
+            // If the writer is busy saving, keep showing the lines we have.
+            scoreWriter.tryWithStore([&](ScoreStore& store) {
+                if (checkScores || scoreCheck.getElapsedTime().asSeconds() >= 1) {
+                    TRACE_SPAN("score reload");
+                    store.reloadIfChanged();
+                    scoreCheck.restart();
+                    checkScores = false;
+                }
+                if (shownRevision != store.getRevision()) {
+                    vector<int> topScores = store.top(5);
+                    scoreLines.clear();
+                    for (size_t i = 0; i < topScores.size(); ++i) {
+                        scoreLines.emplace_back("Score " + to_string(i + 1) + ": " + to_string(topScores[i]), font, 24);
+                        scoreLines.back().setPosition(180, 100 + i * 40);
+                        scoreLines.back().setFillColor(sf::Color::White);
+                    }
+                    shownRevision = store.getRevision();
+                }
+            });
+            for (const sf::Text& t : scoreLines) window.draw(t);
+            window.draw(scoresBack);
+        }
+
+        if (showStats) {
+            if (statsRefresh.getElapsedTime().asSeconds() >= 0.5f) {
+                string lines = "us       p50    p95    p99";
+                for (int p = 0; p < FrameStats::PhaseCount; p++) {
+                    FrameStats::Phase phase = (FrameStats::Phase)p;
+                    char line[64];
+                    snprintf(line, sizeof line, "\n%-7s %6.0f %6.0f %6.0f", FrameStats::name(p), frameStats.recent(phase, 0.5),
+                             frameStats.recent(phase, 0.95), frameStats.recent(phase, 0.99));
+                    lines += line;
+                }
+                statsText.setString(lines);
+                statsRefresh.restart();
             }
-            sf::Text back("Press ESC to return", font, 20);
-            back.setPosition(180, 350);
-            back.setFillColor(sf::Color::Yellow);
-            window.draw(back);
+            window.draw(statsText);
+        }
+        frameStats.lap(FrameStats::Render);
+        {
+            TRACE_SPAN("display");
+            window.display();
         }
+        frameStats.lap(FrameStats::Display);
+        frameStats.endFrame();
+    }
 
-        window.display();
+    if (!statsFile.empty()) {
+        if (frameStats.write(statsFile)) cout << "frame timings (" << frameStats.frames() << " frames) written to " << statsFile << endl;
+        else cerr << "cannot write " << statsFile << endl;
+    }
+    if (!traceFile.empty()) {
+        if (traceWrite(traceFile)) cout << "trace written to " << traceFile << endl;
+        else cerr << "cannot write trace " << traceFile << " (tracing needs -DSNAKE_TRACE)" << endl;
     }
 
+    delete poller;
     delete game;
     delete arena;
     return 0;
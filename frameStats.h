@@ -0,0 +1,132 @@
+// === Frame Timing ===
+// Where a frame's time goes: the main loop calls lap() after each phase
+// (event polling, game update, drawing, display) and endFrame() at the end,
+// and every phase and the whole frame get a histogram of their durations.
+//
+// Durations are kept in microseconds in log-scale buckets, eight per power
+// of two, so a percentile is off by at most an eighth and a sample costs one
+// clock read and a couple of increments. Each phase has two histograms: the
+// last Recent frames (a ring of samples, the oldest is taken out as a new
+// one goes in), for the on-screen numbers, and all frames, for the report
+// written on exit as CSV or JSON.
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+class FrameStats {
+public:
+    enum Phase { Events, Update, Render, Display, Frame, PhaseCount };
+    static constexpr int Recent = 600; // frames, 10 s at 60 Hz
+
+private:
+    static constexpr int Buckets = 8 + 29 * 8; // up to 2^32 us
+
+    struct Histogram {
+        std::uint32_t counts[Buckets] = {};
+        std::uint64_t total = 0, sum = 0, max = 0;
+        void add(std::uint32_t us, int b) {
+            counts[b]++;
+            total++;
+            sum += us;
+            if (us > max) max = us;
+        }
+    };
+    struct Series {
+        Histogram recent, all;
+        std::uint32_t ring[Recent];
+        int next = 0;
+    };
+
+    Series series[PhaseCount];
+    std::chrono::steady_clock::time_point frameStart, last;
+
+    static int bucket(std::uint32_t us) {
+        if (us < 8) return us;
+        int e = 31;
+        while (!(us >> e)) e--;
+        return 8 + (e - 3) * 8 + ((us >> (e - 3)) & 7);
+    }
+    static double bucketMiddle(int b) {
+        if (b < 8) return b;
+        int e = (b - 8) / 8 + 3, sub = (b - 8) % 8;
+        double width = double(1u << (e - 3));
+        return (8 + sub) * width + width / 2;
+    }
+
+    void record(Phase p, std::chrono::steady_clock::duration d) {
+        std::uint32_t us = (std::uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        Series& s = series[p];
+        if (s.recent.total == Recent) { // take the oldest sample out
+            int old = bucket(s.ring[s.next]);
+            s.recent.counts[old]--;
+            s.recent.total--;
+            s.recent.sum -= s.ring[s.next];
+        }
+        int b = bucket(us);
+        s.recent.add(us, b);
+        s.all.add(us, b);
+        s.ring[s.next] = us;
+        s.next = (s.next + 1) % Recent;
+    }
+
+    static double percentile(const Histogram& h, double q) {
+        if (!h.total) return 0;
+        std::uint64_t rank = (std::uint64_t)(q * (h.total - 1)), seen = 0;
+        for (int b = 0; b < Buckets; b++) {
+            seen += h.counts[b];
+            if (seen > rank) return bucketMiddle(b);
+        }
+        return (double)h.max;
+    }
+
+public:
+    static const char* name(int p) {
+        static const char* names[PhaseCount] = {"events", "update", "render", "display", "frame"};
+        return names[p];
+    }
+
+    void beginFrame() { frameStart = last = std::chrono::steady_clock::now(); }
+
+    // Time since the last lap (or the frame start) goes to phase p.
+    void lap(Phase p) {
+        auto now = std::chrono::steady_clock::now();
+        record(p, now - last);
+        last = now;
+    }
+
+    void endFrame() { record(Frame, std::chrono::steady_clock::now() - frameStart); }
+
+    // Percentile q (0..1) in microseconds, over the last Recent frames or all
+    // of them.
+    double recent(Phase p, double q) const { return percentile(series[p].recent, q); }
+    double overall(Phase p, double q) const { return percentile(series[p].all, q); }
+    std::uint64_t frames() const { return series[Frame].all.total; }
+
+    // One line per phase: count, mean, p50, p95, p99 and max in
+    // microseconds, over all frames; JSON if path ends in ".json", else CSV.
+    bool write(const std::string& path) const {
+        bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        std::ofstream out(path, std::ios::trunc);
+        out << (json ? "{\"unit\": \"us\", \"phases\": [\n" : "phase,count,mean_us,p50_us,p95_us,p99_us,max_us\n");
+        for (int p = 0; p < PhaseCount; p++) {
+            const Histogram& h = series[p].all;
+            double mean = h.total ? (double)h.sum / h.total : 0;
+            Phase ph = (Phase)p;
+            if (json)
+                out << "  {\"phase\": \"" << name(p) << "\", \"count\": " << h.total << ", \"mean\": " << mean
+                    << ", \"p50\": " << overall(ph, 0.5) << ", \"p95\": " << overall(ph, 0.95) << ", \"p99\": "
+                    << overall(ph, 0.99) << ", \"max\": " << h.max << "}" << (p + 1 < PhaseCount ? ",\n" : "\n");
+            else
+                out << name(p) << "," << h.total << "," << mean << "," << overall(ph, 0.5) << "," << overall(ph, 0.95)
+                    << "," << overall(ph, 0.99) << "," << h.max << "\n";
+        }
+        if (json) out << "]}\n";
+        return (bool)out;
+    }
+};
+
+#endif
@@ -0,0 +1,208 @@
+// === Hamiltonian Cycle Solver ===
+// Plays by following a cycle that visits every free cell of the board once,
+// which can never trap the snake, and takes shortcuts along the way while
+// the snake is short enough for them to be safe. It fills the board, so it
+// is the stress test for very long snakes.
+//
+// The cycle is built from 2x2 blocks: the free cells are tiled with blocks
+// (walls must fill whole blocks: any even board for Classic and Complex,
+// and Boundary when its squares land on even cells, as on 20x20), a
+// spanning tree is grown over the blocks, and the cycle runs around it. Each
+// block on its own is a small clockwise loop; joining two blocks swaps the
+// two edges on their shared side for two edges across it. Everything is
+// linear in the number of cells, so 4096x4096 boards build in about a
+// second. If no tiling exists, ready() is false and decide() falls back to
+// the autopilot.
+//
+// Shortcuts: with ord[c] the position of c on the cycle, the snake may jump
+// ahead to any free neighbor as long as it stays well behind its own tail
+// along the cycle. While the body is not laid out in cycle order yet (at
+// the start of a game, or after someone else played some moves) it follows
+// the cycle where it can and uses the autopilot otherwise. Whether it is in
+// order is checked again whenever the previous call was not for the tick
+// just before.
+#ifndef HAMILTON_CYCLE_H
+#define HAMILTON_CYCLE_H
+
+#include <cstdint>
+#include <vector>
+#include "snakeEngine.h"
+#include "autopilot.h"
+
+class CycleSolver {
+    enum { Up = 1, Right = 2, Down = 4, Left = 8 }; // tree edges of a block
+
+    int width = 0, height = 0;
+    int total = 0;            // cells on the cycle
+    std::vector<int> ord;     // position on the cycle, -1 for walls
+    std::vector<int> cycle;   // cell at each position
+    bool built = false, found = false;
+    bool aligned = false;     // body is in cycle order
+    long lastTick = -1;       // game tick of the last decide()
+    Autopilot pilot;
+
+    int forward(int from, int to) const { // steps along the cycle from -> to
+        int d = ord[to] - ord[from];
+        return d < 0 ? d + total : d;
+    }
+
+    // Next cell on the cycle from cell (x, y) in block (bx, by) of a tiling
+    // at offset (ox, oy), given the block's tree edges.
+    int step(int x, int y, int ox, int oy, const std::vector<std::uint8_t>& edges, int bw) const {
+        int sx = ((x - ox) % width + width) % width, sy = ((y - oy) % height + height) % height;
+        int bx = sx / 2, by = sy / 2;
+        int corner = (sx & 1) + 2 * (sy & 1); // 0 TL, 1 TR, 2 BL, 3 BR
+        std::uint8_t e = edges[by * bw + bx];
+        int nx = x, ny = y;
+        switch (corner) {
+            case 0: if (e & Up) ny--; else nx++; break;    // TL: up into the block above, else right
+            case 1: if (e & Right) nx++; else ny++; break; // TR: right into the next block, else down
+            case 3: if (e & Down) ny++; else nx--; break;  // BR: down into the block below, else left
+            default: if (e & Left) nx--; else ny--; break; // BL: left into the previous block, else up
+        }
+        nx = (nx + width) % width;
+        ny = (ny + height) % height;
+        return ny * width + nx;
+    }
+
+    bool tile(const Occupancy& o, int ox, int oy, std::vector<std::uint8_t>& free, int bw, int bh) const {
+        for (int by = 0; by < bh; by++)
+            for (int bx = 0; bx < bw; bx++) {
+                int walls = 0;
+                for (int k = 0; k < 4; k++) {
+                    int x = (ox + 2 * bx + (k & 1)) % width, y = (oy + 2 * by + (k >> 1)) % height;
+                    walls += o.isWall(y * width + x);
+                }
+                if (walls != 0 && walls != 4) return false;
+                free[by * bw + bx] = walls == 0;
+            }
+        return true;
+    }
+
+    void build(const Occupancy& o) {
+        built = true;
+        found = false;
+        width = o.getWidth();
+        height = o.getHeight();
+        if (width % 2 || height % 2) return;
+        int bw = width / 2, bh = height / 2;
+        std::vector<std::uint8_t> free(bw * bh), edges(bw * bh, 0);
+        int ox = -1, oy = -1;
+        for (int t = 0; t < 4 && ox < 0; t++)
+            if (tile(o, t & 1, t >> 1, free, bw, bh)) ox = t & 1, oy = t >> 1;
+        if (ox < 0) return;
+
+        // Spanning tree over free blocks, breadth first from the first one.
+        std::vector<int> queue;
+        queue.reserve(bw * bh);
+        std::vector<std::uint8_t> inTree(bw * bh, 0);
+        int blocks = 0;
+        for (int b = 0; b < bw * bh; b++) blocks += free[b];
+        for (int b = 0; b < bw * bh && queue.empty(); b++)
+            if (free[b]) queue.push_back(b), inTree[b] = 1;
+        for (size_t qh = 0; qh < queue.size(); qh++) {
+            int b = queue[qh], bx = b % bw, by = b / bw;
+            const int nb[4] = {((by + bh - 1) % bh) * bw + bx, by * bw + (bx + 1) % bw,
+                               ((by + 1) % bh) * bw + bx, by * bw + (bx + bw - 1) % bw};
+            const std::uint8_t out[4] = {Up, Right, Down, Left}, in[4] = {Down, Left, Up, Right};
+            for (int d = 0; d < 4; d++) {
+                int n = nb[d];
+                if (!free[n] || inTree[n]) continue;
+                inTree[n] = 1;
+                edges[b] |= out[d];
+                edges[n] |= in[d];
+                queue.push_back(n);
+            }
+        }
+        if ((int)queue.size() != blocks || blocks == 0) return; // free area is not connected
+
+        total = blocks * 4;
+        ord.assign(width * height, -1);
+        cycle.assign(total, 0);
+        int start = ((oy + 2 * (queue[0] / bw)) % height) * width + (ox + 2 * (queue[0] % bw)) % width;
+        int c = start;
+        for (int i = 0; i < total; i++) {
+            if (ord[c] >= 0) return; // closed early: not a single cycle
+            ord[c] = i;
+            cycle[i] = c;
+            c = step(c % width, c / width, ox, oy, edges, bw);
+        }
+        found = c == start;
+    }
+
+    // True if the body runs backwards along the cycle from head to tail.
+    bool checkAligned(const Snake& s) const {
+        int head = s.segment(0), last = 0;
+        for (int i = 1; i < s.size(); i++) {
+            int back = forward(s.segment(i), head);
+            if (back <= last) return false;
+            last = back;
+        }
+        return true;
+    }
+
+    template <class B>
+    static char towards(const B& board, int from, int to) {
+        const char dirs[4] = {'w', 'a', 's', 'd'};
+        for (int d = 0; d < 4; d++)
+            if (board.next(from, d) == to) return dirs[d];
+        return 0;
+    }
+
+public:
+    // Call when the arena changes; a new game on the same arena is noticed
+    // by itself.
+    void reset() {
+        built = false;
+        aligned = false;
+        lastTick = -1;
+    }
+
+    template <class B>
+    bool ready(const BasicEngine<B>& game) {
+        if (!built) build(game.arena.getOccupancy());
+        return found;
+    }
+
+    template <class B>
+    char decide(const BasicEngine<B>& game) {
+        const Occupancy& o = game.arena.getOccupancy();
+        if (!ready(game)) return pilot.decide(game);
+        const B& board = game.board;
+        const Snake& snake = game.snake;
+        int head = snake.segment(0), tail = snake.segment(snake.size() - 1);
+
+        if (game.ticks != lastTick + 1) aligned = false; // new game, or moves we did not choose
+        lastTick = game.ticks;
+        if (!aligned && !(aligned = checkAligned(snake))) {
+            int next = cycle[(ord[head] + 1) % total];
+            if (o.isBody(next)) return pilot.decide(game);
+            return towards(board, head, next);
+        }
+
+        // Room ahead of the head before it would run into the tail; keep a
+        // margin for the tick the snake grows and for rounding at the end.
+        int room = forward(head, tail);
+        const std::vector<int>& fp = game.fruit.getPos();
+        int fruit = board.pack(fp[0], fp[1]);
+        int toFruit = forward(head, fruit);
+        int best = cycle[(ord[head] + 1) % total];
+        int bestLeft = toFruit - 1;
+        if (snake.size() * 2 < total) {
+            for (int d = 0; d < 4; d++) {
+                int n = board.next(head, d);
+                if (o.isWall(n) || o.isBody(n)) continue;
+                int jump = forward(head, n);
+                if (jump > toFruit || jump + 4 >= room) continue;
+                int left = toFruit - jump;
+                if (left < bestLeft) {
+                    bestLeft = left;
+                    best = n;
+                }
+            }
+        }
+        return towards(board, head, best);
+    }
+};
+
+#endif
@@ -0,0 +1,82 @@
+// === Input Queue ===
+// Pending turns for the game loop. Key presses are queued and the game takes
+// one turn per tick, so two quick presses inside one tick (e.g. up then left
+// to go around a corner) both happen instead of the second overwriting the
+// first.
+//
+// SpscRing is a lock-free ring for one producer thread and one consumer
+// thread, used when keys are polled on their own thread. TurnQueue is the
+// small queue owned by the game thread.
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// N must be a power of two. push() fails when the ring is full and pop()
+// when it is empty; neither ever blocks.
+template <class T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "ring size must be a power of two");
+    T items[N];
+    alignas(64) std::atomic<size_t> head{0}; // next slot to read, owned by the consumer
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to write, owned by the producer
+
+public:
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) return false;
+        items[t & (N - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = items[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+// Turns waiting to be applied, at most Capacity of them; extra presses are
+// dropped so the snake never lags far behind the keyboard. A turn is only
+// queued if it changes the direction the snake will have by then and is
+// not a reversal of it.
+class TurnQueue {
+    static const int Capacity = 3;
+    char turns[Capacity];
+    int first = 0, count = 0;
+
+    static char opposite(char d) {
+        return d == 'w' ? 's' : d == 's' ? 'w' : d == 'a' ? 'd' : d == 'd' ? 'a' : 0;
+    }
+
+public:
+    void clear() { first = count = 0; }
+    bool empty() const { return count == 0; }
+
+    // current is the direction the snake is moving in now.
+    bool push(char turn, char current) {
+        char last = count ? turns[(first + count - 1) % Capacity] : current;
+        if (count == Capacity || turn == last || turn == opposite(last)) return false;
+        turns[(first + count++) % Capacity] = turn;
+        return true;
+    }
+
+    // The direction for the next tick: the oldest queued turn, or current.
+    char next(char current) {
+        if (!count) return current;
+        char turn = turns[first];
+        first = (first + 1) % Capacity;
+        count--;
+        return turn;
+    }
+};
+
+#endif
@@ -0,0 +1,243 @@
+// === Monte Carlo Tree Search Bot ===
+// Picks each move by playing many short random games ("rollouts") from the
+// current state and keeping statistics on which first moves did best.
+//
+// Every worker of a WorkPool grows its own search tree for the time budget
+// (root parallelism), and the root visit counts are added up at the end; the
+// most visited move wins. The tree is open loop: a node is a sequence of
+// moves, and the state is re-simulated from the root on every iteration,
+// since fruit placement is random. A rollout scores the fruit it eats
+// (sooner is worth more) and loses a point if the snake dies.
+//
+// Iterations do not copy the game. Each worker copies the snake and the
+// occupancy once per decision, and every move an iteration makes is logged
+// (new head, freed tail, eaten and respawned fruit) and taken back in
+// reverse afterwards, so an iteration costs its moves, not the board size.
+// Only when the snake is within horizon moves of filling its ring, where
+// the moves would overwrite its own cells, is the state copied back
+// instead. Each worker has its own Fruit with its own generator, so
+// rollouts do not see where the real game will put the next fruit.
+#ifndef MCTS_BOT_H
+#define MCTS_BOT_H
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "snakeEngine.h"
+#include "workPool.h"
+
+class MctsBot {
+    struct Node {
+        int child[4] = {-1, -1, -1, -1};
+        int visits = 0;
+        double total = 0;
+    };
+
+    // What one move changed, to take it back.
+    struct Undo {
+        int head;  // cell the head moved into
+        int tail;  // cell the tail left, -1 if the snake grew
+        int fruit; // cell the fruit respawned on, -1 if none was eaten or the board filled
+        bool ate;
+    };
+
+    struct Worker {
+        std::vector<Node> nodes;
+        std::vector<int> path;
+        std::vector<Undo> undo;
+        Snake snake;
+        Snake::Mark root;
+        Occupancy occ;
+        Fruit fruit;
+        Score score;
+        std::mt19937 rng;
+        long rollouts = 0, steps = 0;
+        explicit Worker(unsigned seed) : fruit(0, 0, 1, seed), rng(seed) {}
+    };
+
+    WorkPool pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::chrono::microseconds budget;
+    int horizon;
+    static constexpr double Explore = 1.0;
+    static constexpr double Discount = 0.97;
+
+    static char dirOf(int d) {
+        const char dirs[4] = {'w', 'a', 's', 'd'};
+        return dirs[d];
+    }
+
+    template <class B>
+    static int safeMoves(const B& board, const Snake& s, const Occupancy& o, int* out) {
+        int n = 0, head = s.segment(0), back = dirIndex(s.checkDir()) ^ 2;
+        for (int d = 0; d < 4; d++) {
+            if (d == back) continue;
+            int c = board.next(head, d);
+            if (!o.isWall(c) && !o.isBody(c)) out[n++] = d;
+        }
+        return n;
+    }
+
+    template <class B>
+    static char move(Worker& w, const B& board, int d) {
+        int tail = w.snake.segment(w.snake.size() - 1), length = w.snake.size(), before = w.score.getScore();
+        char status = w.snake.move(board, dirOf(d), w.fruit, w.score, w.occ);
+        if (status == 'G' || status == 'W') {
+            bool ate = w.score.getScore() != before;
+            const std::vector<int>& fp = w.fruit.getPos();
+            w.undo.push_back(Undo{w.snake.segment(0), w.snake.size() > length ? -1 : tail,
+                                  ate && status == 'G' ? board.pack(fp[0], fp[1]) : -1, ate});
+        }
+        return status;
+    }
+
+    // Takes back the logged moves, newest first.
+    static void rewind(Worker& w) {
+        for (size_t i = w.undo.size(); i-- > 0;) {
+            const Undo& u = w.undo[i];
+            if (u.ate) {
+                if (u.fruit >= 0) w.occ.clearFruit(u.fruit);
+                w.occ.setFruit(u.head);
+            }
+            if (u.tail >= 0) w.occ.setBody(u.tail);
+            w.occ.clearBody(u.head);
+        }
+        w.undo.clear();
+        w.snake.rewind(w.root);
+    }
+
+    // Copy of the game's snake and occupancy for a worker to try moves on.
+    template <class B>
+    static void load(Worker& w, const BasicEngine<B>& game) {
+        w.snake = game.snake;
+        w.root = w.snake.mark();
+        w.occ = game.arena.getOccupancy();
+        w.undo.clear();
+    }
+
+    // One iteration: walk the tree by UCB, add a node, finish with a random
+    // rollout and back the result up the path.
+    template <class B>
+    void iterate(Worker& w, const BasicEngine<B>& game) {
+        const B& board = game.board;
+        const std::vector<int>& fp = game.fruit.getPos();
+        w.fruit.setPos(fp[0], fp[1]);
+        w.score = Score();
+        w.path.clear();
+
+        double value = 0, weight = 1;
+        char status = 'G';
+        int node = 0, depth = 0;
+        int moves[4];
+        w.path.push_back(0);
+        // Selection and expansion.
+        while (status == 'G' && depth < horizon) {
+            int n = safeMoves(board, w.snake, w.occ, moves);
+            if (n == 0) {
+                status = 's';
+                break;
+            }
+            Node& cur = w.nodes[node];
+            int pick = -1;
+            for (int i = 0; i < n && pick < 0; i++)
+                if (cur.child[moves[i]] < 0) pick = moves[i];
+            bool expand = pick >= 0;
+            if (expand) {
+                int id = (int)w.nodes.size();
+                w.nodes.emplace_back();
+                w.nodes[node].child[pick] = id;
+            } else {
+                double best = -1e300, logN = std::log((double)cur.visits + 1);
+                for (int i = 0; i < n; i++) {
+                    const Node& c = w.nodes[cur.child[moves[i]]];
+                    double ucb = c.total / c.visits + Explore * std::sqrt(logN / c.visits);
+                    if (ucb > best) best = ucb, pick = moves[i];
+                }
+            }
+            node = w.nodes[node].child[pick];
+            w.path.push_back(node);
+            int before = w.score.getScore();
+            status = move(w, board, pick);
+            value += (w.score.getScore() - before) * weight;
+            weight *= Discount;
+            depth++;
+            if (expand) break;
+        }
+        // Rollout.
+        while (status == 'G' && depth < horizon) {
+            int n = safeMoves(board, w.snake, w.occ, moves);
+            if (n == 0) {
+                status = 's';
+                break;
+            }
+            int before = w.score.getScore();
+            status = move(w, board, moves[w.rng() % n]);
+            value += (w.score.getScore() - before) * weight;
+            weight *= Discount;
+            depth++;
+        }
+        w.steps += depth;
+        if (status == 'b' || status == 's') value -= 1;
+        for (int id : w.path) {
+            w.nodes[id].visits++;
+            w.nodes[id].total += value;
+        }
+        w.rollouts++;
+        if (w.snake.capacity() - game.snake.size() >= horizon) rewind(w);
+        else load(w, game); // the moves may have wrapped onto the body
+    }
+
+public:
+    // budgetMs is the thinking time per move; horizon the moves per rollout.
+    explicit MctsBot(int budgetMs = 20, int rolloutHorizon = 40, unsigned threads = std::thread::hardware_concurrency())
+        : pool(threads), budget(budgetMs * 1000), horizon(rolloutHorizon) {
+        std::random_device seeds;
+        for (unsigned i = 0; i < pool.size(); i++) workers.emplace_back(new Worker(seeds()));
+    }
+
+    unsigned threads() const { return pool.size(); }
+
+    // Rollouts and simulated steps since construction, over all workers.
+    long rollouts() const {
+        long n = 0;
+        for (const auto& w : workers) n += w->rollouts;
+        return n;
+    }
+    long steps() const {
+        long n = 0;
+        for (const auto& w : workers) n += w->steps;
+        return n;
+    }
+
+    template <class B>
+    char decide(const BasicEngine<B>& game) {
+        auto deadline = std::chrono::steady_clock::now() + budget;
+        for (auto& wp : workers) {
+            Worker* w = wp.get();
+            pool.submit([this, w, &game, deadline] {
+                w->nodes.clear();
+                w->nodes.emplace_back();
+                load(*w, game);
+                do {
+                    for (int i = 0; i < 16; i++) iterate(*w, game);
+                } while (std::chrono::steady_clock::now() < deadline);
+            });
+        }
+        pool.wait();
+
+        int visits[4] = {0, 0, 0, 0};
+        for (auto& w : workers)
+            for (int d = 0; d < 4; d++) {
+                int c = w->nodes[0].child[d];
+                if (c >= 0) visits[d] += w->nodes[c].visits;
+            }
+        int best = -1;
+        for (int d = 0; d < 4; d++)
+            if (visits[d] > 0 && (best < 0 || visits[d] > visits[best])) best = d;
+        return best < 0 ? game.snake.checkDir() : dirOf(best);
+    }
+};
+
+#endif
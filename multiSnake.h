@@ -0,0 +1,250 @@
+// === Multi-Snake Arena ===
+// Many snakes, human or bot, sharing one large board. A single grid of
+// cells says what is where (wall, fruit, or which snake's body), so every
+// collision is one lookup and a tick only touches each moving snake's head
+// and tail: the cost grows with the number of snakes, not their lengths.
+//
+// A tick runs in two passes over the live snakes, in id order. The first
+// pass works out each head's target; a target that is a wall or any body
+// (including tails about to move, as in the single-player rules) kills the
+// snake. Two or more heads on the same free cell are a head-on collision:
+// the longest snake wins and the others die; equal lengths go to the lower
+// id, so the outcome never depends on anything but the state. The second
+// pass moves the survivors and removes the dead, whose bodies are freed.
+//
+// Fruit is kept at a fixed count: eaten fruit is put back on random free
+// cells at the end of the tick. Snakes are respawned only when the caller
+// asks (spawn()).
+//
+// The arena is a plain value driven only by its seed and the inputs, so a
+// copy is a snapshot, copy-assigning one back (which reuses the storage)
+// restores it, and two copies fed the same inputs stay identical.
+#ifndef MULTI_SNAKE_H
+#define MULTI_SNAKE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "snakeEngine.h"
+
+class MultiSnakeArena {
+public:
+    enum { Empty = 0, Wall = -1, FruitCell = -2 }; // grid values; a body is id + 1
+
+    struct Player {
+        std::vector<int> ring; // body, power-of-two capacity, grows as needed
+        int head = 0, tail = 0, growth = 0;
+        std::uint8_t dir = 0;  // dirIndex
+        std::uint8_t wanted = 0;
+        bool alive = false;
+        int score = 0;
+        int length() const { return ((head - tail) & ((int)ring.size() - 1)) + 1; }
+        int headCell() const { return ring[head]; }
+    };
+
+private:
+    Board board;
+    std::vector<int> grid;
+    std::vector<Player> players;
+    std::vector<int> live;         // ids of live snakes, ascending
+    std::vector<int> target;       // per player, this tick's head cell or -1
+    std::vector<long> claimTick;   // per cell: last tick a head claimed it
+    std::vector<int> claimedBy;    // per cell: who holds that claim
+    std::uint64_t rng;
+    int fruitTarget, fruits = 0;
+    long tick = 0;
+    long deaths = 0;
+
+    std::uint64_t random() { // splitmix64
+        std::uint64_t z = (rng += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    int randomCell() { return (int)((random() >> 32) * (std::uint64_t)board.cells() >> 32); }
+
+    bool placeFruit() {
+        for (int tries = 0; tries < 64; tries++) {
+            int c = randomCell();
+            if (grid[c] == Empty) return grid[c] = FruitCell, fruits++, true;
+        }
+        return false; // crowded; step() tries again next tick
+    }
+
+    static void push(Player& p, int cell) {
+        int size = (int)p.ring.size();
+        if (p.length() == size) { // full: unroll into a ring twice the size
+            std::vector<int> bigger(size * 2);
+            for (int i = 0; i < size; i++) bigger[i] = p.ring[(p.tail + i) & (size - 1)];
+            p.ring.swap(bigger);
+            p.tail = 0;
+            p.head = size - 1;
+        }
+        p.head = (p.head + 1) & ((int)p.ring.size() - 1);
+        p.ring[p.head] = cell;
+    }
+
+    void kill(int id) {
+        Player& p = players[id];
+        for (int i = p.tail;; i = (i + 1) & ((int)p.ring.size() - 1)) {
+            grid[p.ring[i]] = Empty;
+            if (i == p.head) break;
+        }
+        p.alive = false;
+        deaths++;
+    }
+
+public:
+    MultiSnakeArena(const Arena& arena, int fruits, std::uint64_t seed)
+        : board(arena.getWidth(), arena.getHeight()), grid(board.cells(), Empty), claimTick(board.cells(), -1),
+          claimedBy(board.cells(), 0), rng(seed), fruitTarget(fruits) {
+        const Occupancy& o = arena.getOccupancy();
+        for (int c = 0; c < board.cells(); c++)
+            if (o.isWall(c)) grid[c] = Wall;
+        for (int i = 0; i < fruits; i++) placeFruit();
+    }
+
+    int width() const { return board.width; }
+    int height() const { return board.height; }
+    long ticks() const { return tick; }
+    long totalDeaths() const { return deaths; }
+    int cell(int c) const { return grid[c]; }
+    const std::vector<int>& alive() const { return live; }
+    const Player& player(int id) const { return players[id]; }
+    int playerCount() const { return (int)players.size(); }
+
+    // Adds a snake (id = -1) or brings back a dead one: three cells in a
+    // random free vertical strip, heading up. Returns the id, or -1 if no
+    // room was found.
+    int spawn(int id = -1) {
+        for (int tries = 0; tries < 64; tries++) {
+            int c0 = randomCell();
+            int c1 = board.next(c0, 2), c2 = board.next(c1, 2);
+            if (grid[c0] != Empty || grid[c1] != Empty || grid[c2] != Empty) continue;
+            if (id < 0) {
+                id = (int)players.size();
+                players.emplace_back();
+                target.push_back(-1);
+            }
+            Player& p = players[id];
+            p.ring.assign(4, 0);
+            p.ring[0] = c2;
+            p.ring[1] = c1;
+            p.ring[2] = c0;
+            p.tail = 0;
+            p.head = 2;
+            p.growth = 0;
+            p.dir = p.wanted = 0;
+            p.score = 0;
+            p.alive = true;
+            for (int c : {c0, c1, c2}) grid[c] = id + 1;
+            live.insert(std::lower_bound(live.begin(), live.end(), id), id);
+            return id;
+        }
+        return -1;
+    }
+
+    // Hash of the whole state, for checking that two copies of a game that
+    // were fed the same inputs are still the same.
+    std::uint64_t checksum() const {
+        std::uint64_t h = 1469598103934665603ULL; // FNV-1a over 32-bit words
+        auto mix = [&h](std::uint64_t v) { h = (h ^ (v & 0xffffffffu) ^ (v >> 32)) * 1099511628211ULL; };
+        mix(tick);
+        mix(rng);
+        for (int c : grid) mix((std::uint32_t)c);
+        for (int id : live) {
+            const Player& p = players[id];
+            mix(p.ring[p.head]);
+            mix(p.ring[p.tail]);
+            mix(p.dir | p.wanted << 2 | p.growth << 4);
+            mix(p.score);
+        }
+        return h;
+    }
+
+    // Input for the next tick; reversals are ignored.
+    void turn(int id, char d) {
+        Player& p = players[id];
+        int want = dirIndex(d);
+        if (want != (p.dir ^ 2)) p.wanted = (std::uint8_t)want;
+    }
+
+    // Simple bot input: keep going if the cell ahead is free or fruit,
+    // otherwise take a free side turn (picked with the arena's generator).
+    void steerBot(int id) {
+        Player& p = players[id];
+        int ahead = board.next(p.headCell(), p.dir);
+        if (grid[ahead] == Empty || grid[ahead] == FruitCell) {
+            p.wanted = p.dir;
+            return;
+        }
+        int side[2] = {(p.dir + 1) & 3, (p.dir + 3) & 3};
+        if (random() & 1) std::swap(side[0], side[1]);
+        for (int d : side) {
+            int c = board.next(p.headCell(), d);
+            if (grid[c] == Empty || grid[c] == FruitCell) {
+                p.wanted = (std::uint8_t)d;
+                return;
+            }
+        }
+        p.wanted = p.dir;
+    }
+
+    // Advances every live snake one step. Returns how many died.
+    int step() {
+        tick++;
+        // Pass 1: targets, wall/body hits and head-on claims.
+        for (int id : live) {
+            Player& p = players[id];
+            p.dir = p.wanted;
+            int c = board.next(p.headCell(), p.dir);
+            target[id] = -1;
+            if (grid[c] != Empty && grid[c] != FruitCell) continue; // hit a wall or a body
+            if (claimTick[c] != tick) {
+                claimTick[c] = tick;
+                claimedBy[c] = id;
+                target[id] = c;
+                continue;
+            }
+            int other = claimedBy[c];
+            if (p.length() > players[other].length()) { // ties keep the lower id, which claimed first
+                target[other] = -1;
+                claimedBy[c] = id;
+                target[id] = c;
+            }
+        }
+        // Pass 2: move the survivors, then remove the dead.
+        int died = 0;
+        for (int id : live) {
+            if (target[id] < 0) continue;
+            Player& p = players[id];
+            int c = target[id];
+            bool ate = grid[c] == FruitCell;
+            push(p, c);
+            grid[c] = id + 1;
+            if (ate) {
+                p.growth++;
+                p.score++;
+                fruits--;
+            }
+            if (p.growth > 0) p.growth--;
+            else {
+                grid[p.ring[p.tail]] = Empty;
+                p.tail = (p.tail + 1) & ((int)p.ring.size() - 1);
+            }
+        }
+        size_t kept = 0;
+        for (int id : live) {
+            if (target[id] < 0) {
+                kill(id);
+                died++;
+            } else live[kept++] = id;
+        }
+        live.resize(kept);
+        while (fruits < fruitTarget && placeFruit()) {}
+        return died;
+    }
+};
+
+#endif
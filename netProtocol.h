@@ -0,0 +1,209 @@
+// === Network Protocol ===
+// What the tick server (snakeServer.cpp) and its clients say to each other
+// over TCP.
+//
+// Client to server: one byte per turn, 'w', 'a', 's' or 'd'.
+// Server to client, per game:
+//   0x80 varint(length) payload   start of a new game
+//   0x81 varint(length) payload   keyframe of the running game (optional)
+//   payload: varint width, height, mode:u8, varint ticks, score, end:u8,
+//            varint fruit cell, snake length, head cell, then the direction
+//            from each segment to the next one towards the tail, four per
+//            byte (dirIndex, low bits first)
+//   delta byte, one per tick: bits 0-1 the head's direction, bit 2 the head
+//            moved, bit 3 the tail moved, bit 4 the fruit moved (varint cell
+//            follows), bit 5 the game ended (end code follows)
+// A tick usually costs a client one byte whatever the board size; the score
+// is not sent, a client counts the fruit its head lands on.
+//
+// NetMirror is the client side: it rebuilds the game from these messages
+// and counts any keyframe that does not match what it has rebuilt.
+#ifndef NET_PROTOCOL_H
+#define NET_PROTOCOL_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "snakeEngine.h"
+
+struct NetProtocol {
+    enum { NewGame = 0x80, Keyframe = 0x81 };
+    enum { Moved = 4, TailMoved = 8, FruitMoved = 16, Ended = 32 };
+
+    // What a delta is taken against: the game just before a step.
+    struct Frame {
+        int head, fruit, size;
+    };
+
+    template <class B>
+    static Frame capture(const BasicEngine<B>& g) {
+        const std::vector<int>& fp = g.fruit.getPos();
+        return Frame{g.snake.segment(0), g.board.pack(fp[0], fp[1]), g.snake.size()};
+    }
+
+    template <class B>
+    static void putDelta(std::string& out, const Frame& before, const BasicEngine<B>& g) {
+        Frame now = capture(g);
+        int flags = 0;
+        if (now.head != before.head) flags |= Moved | dirIndex(g.snake.checkDir());
+        if (flags && now.size == before.size) flags |= TailMoved;
+        if (now.fruit != before.fruit) flags |= FruitMoved;
+        if (g.status != 'G') flags |= Ended;
+        out += (char)flags;
+        if (flags & FruitMoved) putVarint(out, now.fruit);
+        if (flags & Ended) out += g.status;
+    }
+
+    template <class B>
+    static void putSnapshot(std::string& out, const BasicEngine<B>& g, int mode, bool keyframe = false) {
+        std::string p;
+        const Snake& s = g.snake;
+        putVarint(p, g.width());
+        putVarint(p, g.height());
+        p += (char)mode;
+        putVarint(p, g.ticks);
+        putVarint(p, g.score.getScore());
+        p += g.status;
+        putVarint(p, capture(g).fruit);
+        putVarint(p, s.size());
+        putVarint(p, s.segment(0));
+        int packed = 0;
+        for (int i = 1; i < s.size(); i++) {
+            int d = 0;
+            while (d < 3 && g.board.next(s.segment(i - 1), d) != s.segment(i)) d++;
+            packed |= d << (2 * ((i - 1) & 3));
+            if ((i & 3) == 0 || i == s.size() - 1) {
+                p += (char)packed;
+                packed = 0;
+            }
+        }
+        out += (char)(keyframe ? Keyframe : NewGame);
+        putVarint(out, p.size());
+        out += p;
+    }
+
+    static void putVarint(std::string& out, std::uint64_t v) {
+        while (v >= 0x80) {
+            out += (char)(v | 0x80);
+            v >>= 7;
+        }
+        out += (char)v;
+    }
+    static bool getVarint(const char* in, size_t size, size_t& at, std::uint64_t& v) {
+        v = 0;
+        for (int shift = 0; at < size && shift < 64; shift += 7) {
+            unsigned char b = in[at++];
+            v |= (std::uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+// A client's copy of one game, kept up to date from the server's messages.
+class NetMirror {
+    Board board{8, 8};
+    std::vector<std::uint8_t> cells; // 0 free, 1 wall, 2 body
+    int width = 0, height = 0, mode = 0;
+
+    bool readSnapshot(const char* in, size_t size, bool keyframe) {
+        size_t at = 0;
+        std::uint64_t w, h, t, sc, f, len, head;
+        if (!NetProtocol::getVarint(in, size, at, w) || !NetProtocol::getVarint(in, size, at, h) || at >= size) return false;
+        if (w < 8 || h < 8 || w > (std::uint64_t)Board::maxSide || h > (std::uint64_t)Board::maxSide) return false;
+        int m = (unsigned char)in[at++];
+        if (!NetProtocol::getVarint(in, size, at, t) || !NetProtocol::getVarint(in, size, at, sc) || at >= size) return false;
+        char end = in[at++];
+        if (!NetProtocol::getVarint(in, size, at, f) || !NetProtocol::getVarint(in, size, at, len) ||
+            !NetProtocol::getVarint(in, size, at, head))
+            return false;
+        if (f >= w * h || head >= w * h || len < 1 || len > w * h || size - at < (len + 2) / 4) return false;
+        if ((int)w != width || (int)h != height || m != mode) {
+            width = (int)w;
+            height = (int)h;
+            mode = m;
+            board = Board(width, height);
+            Arena arena = makeArena(mode, width, height);
+            cells.assign(board.cells(), 0);
+            for (int c = 0; c < board.cells(); c++) cells[c] = arena.getOccupancy().isWall(c);
+        }
+        std::deque<int> seen;
+        seen.push_back((int)head);
+        for (std::uint64_t i = 1; i < len; i++) {
+            int d = ((unsigned char)in[at + (i - 1) / 4] >> (2 * ((i - 1) & 3))) & 3;
+            seen.push_back(board.next(seen.back(), d));
+        }
+        if (keyframe && (seen != body || (int)f != fruit || (long)t != ticks || (int)sc != score || end != status))
+            mismatches++;
+        for (int c : body) cells[c] = 0;
+        body.swap(seen);
+        for (int c : body) cells[c] = 2;
+        fruit = (int)f;
+        ticks = (long)t;
+        score = (int)sc;
+        status = end;
+        return true;
+    }
+
+    void applyDelta(int flags, int newFruit, char end) {
+        ticks++;
+        deltas++;
+        if (flags & NetProtocol::Moved) {
+            int head = board.next(body.front(), flags & 3);
+            if (cells[head]) mismatches++; // the server never moves into a wall or body
+            body.push_front(head);
+            cells[head] = 2;
+            if (head == fruit) score++;
+            if (flags & NetProtocol::TailMoved) {
+                cells[body.back()] = 0;
+                body.pop_back();
+            }
+        }
+        if (flags & NetProtocol::FruitMoved) fruit = newFruit;
+        if (flags & NetProtocol::Ended) status = end;
+    }
+
+public:
+    std::deque<int> body; // head first
+    int fruit = 0, score = 0;
+    long ticks = 0;
+    char status = 'G';
+    bool started = false;
+    long games = 0, deltas = 0, mismatches = 0;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const Board& getBoard() const { return board; }
+    bool isOpen(int cell) const { return cells[cell] == 0; }
+
+    // Applies the first message in data. Returns the bytes it used, 0 if the
+    // message is not complete yet, or -1 if the data is not valid.
+    int apply(const char* data, size_t size) {
+        if (size == 0) return 0;
+        size_t at = 1;
+        int type = (unsigned char)data[0];
+        if (type == NetProtocol::NewGame || type == NetProtocol::Keyframe) {
+            std::uint64_t len;
+            if (!NetProtocol::getVarint(data, size, at, len)) return at < size ? -1 : 0;
+            if (size - at < len) return 0;
+            if (!readSnapshot(data + at, (size_t)len, type == NetProtocol::Keyframe)) return -1;
+            if (type == NetProtocol::NewGame) games++;
+            started = true;
+            return (int)(at + len);
+        }
+        if (type & 0xc0 || !started) return -1;
+        std::uint64_t f = 0;
+        if ((type & NetProtocol::FruitMoved) && !NetProtocol::getVarint(data, size, at, f)) return 0;
+        if (f >= (std::uint64_t)board.cells()) return -1;
+        char end = 'G';
+        if (type & NetProtocol::Ended) {
+            if (at >= size) return 0;
+            end = data[at++];
+        }
+        applyDelta(type, (int)f, end);
+        return (int)at;
+    }
+};
+
+#endif
@@ -0,0 +1,215 @@
+// === Sockets ===
+// The little of BSD sockets / Winsock the network modes need: non-blocking
+// TCP listen, accept, connect, send and receive, and UDP to a single peer.
+// Nothing here ever blocks; callers poll once per tick. send() and
+// receive() return the bytes moved, 0 if the socket would block, or -1
+// once the connection is gone.
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+static const SocketHandle NoSocket = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketHandle;
+static const SocketHandle NoSocket = -1;
+#endif
+
+// Handle, start-up and error handling shared by both kinds of socket.
+class SocketBase {
+protected:
+    SocketHandle fd = NoSocket;
+
+    static void startup() {
+#ifdef _WIN32
+        static bool started = false;
+        if (!started) {
+            WSADATA data;
+            started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }
+#else
+        std::signal(SIGPIPE, SIG_IGN); // a dropped peer shows up as send() == -1
+#endif
+    }
+    static bool wouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+    }
+    void setNonBlocking() {
+#ifdef _WIN32
+        u_long on = 1;
+        ioctlsocket(fd, FIONBIO, &on);
+#else
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    }
+    explicit SocketBase(SocketHandle h = NoSocket) : fd(h) {}
+
+public:
+    SocketBase(SocketBase&& o) : fd(o.fd) { o.fd = NoSocket; }
+    SocketBase& operator=(SocketBase&& o) {
+        std::swap(fd, o.fd);
+        return *this;
+    }
+    SocketBase(const SocketBase&) = delete;
+    SocketBase& operator=(const SocketBase&) = delete;
+    ~SocketBase() { close(); }
+
+    bool isOpen() const { return fd != NoSocket; }
+    void close() {
+        if (fd == NoSocket) return;
+#ifdef _WIN32
+        closesocket(fd);
+#else
+        ::close(fd);
+#endif
+        fd = NoSocket;
+    }
+};
+
+class TcpSocket : public SocketBase {
+    void setOptions() {
+        setNonBlocking();
+        int one = 1; // small messages every tick: do not wait to fill packets
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof one);
+    }
+    explicit TcpSocket(SocketHandle h) : SocketBase(h) {}
+
+public:
+    TcpSocket() {}
+
+    // Listens on all interfaces; check isOpen().
+    static TcpSocket listen(int port) {
+        startup();
+        TcpSocket s(::socket(AF_INET, SOCK_STREAM, 0));
+        if (!s.isOpen()) return s;
+        int one = 1;
+        setsockopt(s.fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&one, sizeof one);
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof addr);
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((unsigned short)port);
+        if (::bind(s.fd, (sockaddr*)&addr, sizeof addr) != 0 || ::listen(s.fd, 128) != 0) s.close();
+        else s.setOptions();
+        return s;
+    }
+
+    // A pending connection, or a closed socket if there is none.
+    TcpSocket accept() {
+        TcpSocket c(::accept(fd, nullptr, nullptr));
+        if (c.isOpen()) c.setOptions();
+        return c;
+    }
+
+    // Blocking connect (only done at start-up), then non-blocking.
+    static TcpSocket connect(const std::string& host, int port) {
+        startup();
+        addrinfo hints, *found = nullptr;
+        std::memset(&hints, 0, sizeof hints);
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        TcpSocket s;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0) return s;
+        s = TcpSocket(::socket(AF_INET, SOCK_STREAM, 0));
+        if (s.isOpen() && ::connect(s.fd, found->ai_addr, (int)found->ai_addrlen) != 0) s.close();
+        freeaddrinfo(found);
+        if (s.isOpen()) s.setOptions();
+        return s;
+    }
+
+    int send(const char* data, int size) {
+#ifdef MSG_NOSIGNAL
+        int n = (int)::send(fd, data, size, MSG_NOSIGNAL);
+#else
+        int n = (int)::send(fd, data, size, 0);
+#endif
+        if (n >= 0) return n;
+        return wouldBlock() ? 0 : -1;
+    }
+
+    int receive(char* data, int size) {
+        int n = (int)::recv(fd, data, size, 0);
+        if (n > 0) return n;
+        if (n == 0) return -1; // closed by the peer
+        return wouldBlock() ? 0 : -1;
+    }
+};
+
+// Datagrams to and from one peer, e.g. the other player of a two-player
+// game. A datagram is sent whole or not at all, and may be lost.
+class UdpSocket : public SocketBase {
+    sockaddr_in peer;
+    explicit UdpSocket(SocketHandle h) : SocketBase(h) { std::memset(&peer, 0, sizeof peer); }
+
+    // The error left by an earlier datagram to a peer that was not
+    // listening yet; not a reason to give up.
+    static bool refused() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAECONNRESET;
+#else
+        return errno == ECONNREFUSED;
+#endif
+    }
+
+public:
+    UdpSocket() { std::memset(&peer, 0, sizeof peer); }
+
+    // Bound to port on all interfaces, sending to host:peerPort; check isOpen().
+    static UdpSocket open(int port, const std::string& host, int peerPort) {
+        startup();
+        UdpSocket s(::socket(AF_INET, SOCK_DGRAM, 0));
+        if (!s.isOpen()) return s;
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof addr);
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((unsigned short)port);
+        addrinfo hints, *found = nullptr;
+        std::memset(&hints, 0, sizeof hints);
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        if (::bind(s.fd, (sockaddr*)&addr, sizeof addr) != 0 ||
+            getaddrinfo(host.c_str(), std::to_string(peerPort).c_str(), &hints, &found) != 0) {
+            s.close();
+            return s;
+        }
+        std::memcpy(&s.peer, found->ai_addr, sizeof s.peer);
+        freeaddrinfo(found);
+        s.setNonBlocking();
+        return s;
+    }
+
+    int send(const char* data, int size) {
+        int n = (int)::sendto(fd, data, size, 0, (const sockaddr*)&peer, sizeof peer);
+        if (n >= 0) return n;
+        return wouldBlock() || refused() ? 0 : -1;
+    }
+
+    // One datagram, or 0 if none is waiting.
+    int receive(char* data, int size) {
+        int n = (int)::recvfrom(fd, data, size, 0, nullptr, nullptr);
+        if (n >= 0) return n;
+        return wouldBlock() || refused() ? 0 : -1;
+    }
+};
+
+#endif
@@ -0,0 +1,170 @@
+// === Replays ===
+// A recorded game: the seed, arena mode, board size and speed level it was
+// started with, the turns that were taken, and the outcome as the recording
+// front end saw it. Re-running the same turns on a new engine with the same
+// seed gives the same game, so a replay can be played back, checked or used
+// as a regression test.
+//
+// File layout (little-endian, varints are LEB128):
+//   "SNRP" version:u8 seed:u32 mode:u8 speed:u8 width:u16 height:u16
+//   ticks:varint score:varint end:u8 turnCount:varint
+//   per turn: varint((ticks since previous turn << 2) | dirIndex)
+// Most turns are a few ticks apart, so a turn usually costs one byte.
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "snakeEngine.h"
+
+struct Replay {
+    std::uint32_t seed = 0;
+    int mode = 1, speed = 2;
+    int width = 20, height = 20;
+    std::vector<TurnEvent> turns;
+    // Outcome when recorded.
+    long ticks = 0;
+    int score = 0;
+    char end = 'G';
+
+    bool save(const std::string& path) const {
+        std::string out = "SNRP";
+        out += (char)1;
+        putFixed(out, seed, 4);
+        out += (char)mode;
+        out += (char)speed;
+        putFixed(out, width, 2);
+        putFixed(out, height, 2);
+        putVarint(out, ticks);
+        putVarint(out, score);
+        out += end;
+        putVarint(out, turns.size());
+        long last = 0;
+        for (const TurnEvent& t : turns) {
+            putVarint(out, (std::uint64_t)(t.tick - last) << 2 | dirIndex(t.dir));
+            last = t.tick;
+        }
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), out.size());
+        return (bool)file;
+    }
+
+    // Returns false if the file is missing, truncated or not a replay.
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        std::string in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        size_t at = 0;
+        if (in.compare(0, 4, "SNRP") != 0 || in.size() < 15 || in[4] != 1) return false;
+        at = 5;
+        std::uint64_t v, count;
+        seed = (std::uint32_t)getFixed(in, at, 4);
+        mode = (unsigned char)in[at++];
+        if (mode < 1 || mode > 3) return false;
+        speed = (unsigned char)in[at++];
+        width = (int)getFixed(in, at, 2);
+        height = (int)getFixed(in, at, 2);
+        if (width < 8 || height < 8 || width > Board::maxSide || height > Board::maxSide) return false;
+        if (!getVarint(in, at, v)) return false;
+        ticks = (long)v;
+        if (!getVarint(in, at, v) || at >= in.size()) return false;
+        score = (int)v;
+        end = in[at++];
+        if (!getVarint(in, at, count) || count > in.size()) return false;
+        const char dirs[4] = {'w', 'a', 's', 'd'};
+        turns.clear();
+        turns.reserve(count);
+        long tick = 0;
+        for (std::uint64_t i = 0; i < count; i++) {
+            if (!getVarint(in, at, v)) return false;
+            tick += (long)(v >> 2);
+            turns.push_back(TurnEvent{tick, dirs[v & 3]});
+        }
+        return true;
+    }
+
+private:
+    static void putFixed(std::string& out, std::uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; i++) out += (char)(v >> (8 * i));
+    }
+    static std::uint64_t getFixed(const std::string& in, size_t& at, int bytes) {
+        std::uint64_t v = 0;
+        for (int i = 0; i < bytes; i++) v |= (std::uint64_t)(unsigned char)in[at++] << (8 * i);
+        return v;
+    }
+    static void putVarint(std::string& out, std::uint64_t v) {
+        while (v >= 0x80) {
+            out += (char)(v | 0x80);
+            v >>= 7;
+        }
+        out += (char)v;
+    }
+    static bool getVarint(const std::string& in, size_t& at, std::uint64_t& v) {
+        v = 0;
+        for (int shift = 0; at < in.size() && shift < 64; shift += 7) {
+            unsigned char b = in[at++];
+            v |= (std::uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+};
+
+// Feeds a replay's turns to an engine: key(tick) is the input for that step.
+class ReplayInput {
+    const Replay& replay;
+    size_t next = 0;
+public:
+    explicit ReplayInput(const Replay& r) : replay(r) {}
+    char key(long tick) {
+        while (next < replay.turns.size() && replay.turns[next].tick < tick) next++;
+        if (next < replay.turns.size() && replay.turns[next].tick == tick) return replay.turns[next++].dir;
+        return 0; // keep going straight
+    }
+};
+
+struct ReplayResult {
+    long ticks;
+    int score;
+    char end; // 'G' if the game was still running after the recorded ticks
+    bool stalled; // gave up after stallTicks(r) ticks without a fruit
+};
+
+// A game that goes this long without eating is not one a player would have
+// recorded (the same limit snakeBench stops bots at), so the tick count in
+// the file cannot make a check run for as long as it says.
+inline long stallTicks(const Replay& r) { return 8L * r.width * r.height; }
+
+// Re-simulates a replay with no output, stopping when the game ends, at the
+// recorded tick count or after stallTicks(r) ticks without a fruit,
+// whichever comes first.
+template <class B>
+ReplayResult simulateOn(const Replay& r) {
+    BasicEngine<B> game(makeArena(r.mode, r.width, r.height), r.seed);
+    ReplayInput input(r);
+    const long limit = stallTicks(r);
+    long lastMeal = 0;
+    int lastScore = 0;
+    bool stalled = false;
+    while (game.status == 'G' && game.ticks < r.ticks) {
+        game.step(input.key(game.ticks));
+        if (game.score.getScore() != lastScore) {
+            lastScore = game.score.getScore();
+            lastMeal = game.ticks;
+        } else if (game.ticks - lastMeal > limit) {
+            stalled = true;
+            break;
+        }
+    }
+    return ReplayResult{game.ticks, game.score.getScore(), game.status, stalled};
+}
+
+inline ReplayResult simulate(const Replay& r) {
+    if (r.width == 20 && r.height == 20) return simulateOn<FixedBoard<20, 20>>(r);
+    return simulateOn<Board>(r);
+}
+
+#endif
@@ -0,0 +1,149 @@
+// === Rollback ===
+// Two-player lockstep with prediction and rollback. Both peers run the same
+// game from the same seed and exchange only their inputs. A peer never waits
+// for the other one's input for a tick: it predicts "no turn", keeps going,
+// and if the real input turns out to be different it restores the state from
+// before that tick and simulates forward again with what it now knows.
+//
+// The game is a MultiSnakeArena with one snake per player, which is
+// deterministic and copyable: the state before each of the last Window
+// ticks is kept by copy-assigning into a ring of saved arenas (no
+// allocation once they have grown), and a rollback is one copy back plus
+// the re-simulated ticks. A dead snake is respawned as part of the tick, so
+// a session runs until the caller stops it.
+//
+// Inputs are 'w', 'a', 's', 'd' or 0 for no turn. The local player's input
+// goes into tick frameCount() + delay; a small delay means fewer
+// mispredictions at the cost of that many ticks of input lag. advance()
+// refuses to run more than Window - 1 ticks past the other player's last
+// known input.
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <chrono>
+#include <vector>
+#include "multiSnake.h"
+
+class RollbackSession {
+public:
+    static constexpr int Window = 64;      // ticks that can be rolled back
+    static constexpr int Inputs = Window * 4; // input history per player
+
+private:
+    MultiSnakeArena game;
+    std::vector<MultiSnakeArena> saved; // state before tick t at t % Window
+    char input[2][Inputs];
+    long inputTick[2][Inputs];           // tick each slot holds, -1 if none
+    char used[Window];                   // remote input the last run of tick t used
+    int local, delay;
+    long frame = 0;                      // ticks simulated
+    long confirmed = -1;                 // remote inputs known up to here
+    long localUpTo = -1;                 // local inputs set up to here
+    long resimulateFrom = -1;            // earliest mispredicted tick, -1 if none
+    long rollbacks = 0, resimulated = 0;
+    int deepest = 0;
+    std::chrono::nanoseconds copyTime{0};
+    long copies = 0;
+
+    char inputAt(int player, long t) const {
+        int i = (int)(t % Inputs);
+        return inputTick[player][i] == t ? input[player][i] : 0;
+    }
+    void setInput(int player, long t, char d) {
+        int i = (int)(t % Inputs);
+        input[player][i] = d;
+        inputTick[player][i] = t;
+    }
+
+    void save(long t) {
+        auto start = std::chrono::steady_clock::now();
+        saved[t % Window] = game;
+        copyTime += std::chrono::steady_clock::now() - start;
+        copies++;
+    }
+
+    // One tick from the current state, which must be the state before tick t.
+    void simulate(long t) {
+        save(t);
+        char remote = t <= confirmed ? inputAt(1 - local, t) : 0; // prediction: no turn
+        used[t % Window] = remote;
+        char mine = inputAt(local, t);
+        char first = local == 0 ? mine : remote, second = local == 0 ? remote : mine;
+        if (first) game.turn(0, first);
+        if (second) game.turn(1, second);
+        game.step();
+        for (int id = 0; id < 2; id++)
+            if (!game.player(id).alive) game.spawn(id);
+    }
+
+public:
+    // start must hold the two players' snakes, ids 0 and 1; local is which
+    // of them is played here.
+    RollbackSession(const MultiSnakeArena& start, int localPlayer, int inputDelay)
+        : game(start), saved(Window, start), local(localPlayer), delay(inputDelay) {
+        for (int p = 0; p < 2; p++)
+            for (int i = 0; i < Inputs; i++) inputTick[p][i] = -1;
+        for (long t = 0; t < delay; t++) setInput(local, t, 0);
+        localUpTo = delay - 1;
+    }
+
+    const MultiSnakeArena& state() const { return game; }
+    long frameCount() const { return frame; }
+    long confirmedRemote() const { return confirmed; }
+    long localInputsUpTo() const { return localUpTo; }
+    char localInput(long t) const { return inputAt(local, t); }
+    long rollbackCount() const { return rollbacks; }
+    long resimulatedTicks() const { return resimulated; }
+    int deepestRollback() const { return deepest; }
+    // Average time to save or restore a state.
+    double copyMicros() const { return copies ? copyTime.count() / 1000.0 / copies : 0; }
+
+    // True while every tick simulated so far used real inputs only.
+    bool settled() const { return frame <= confirmed + 1 && resimulateFrom < 0; }
+
+    // An input from the other player. Older inputs than the last confirmed
+    // one (resent copies) are ignored.
+    void addRemoteInput(long t, char d) {
+        if (t <= confirmed || t > confirmed + Inputs - Window) return;
+        setInput(1 - local, t, d);
+        long before = confirmed;
+        while (inputTick[1 - local][(confirmed + 1) % Inputs] == confirmed + 1) confirmed++;
+        // Ticks already run with a prediction that turned out wrong.
+        for (long k = before + 1; k <= confirmed && k < frame; k++)
+            if (used[k % Window] != inputAt(1 - local, k)) {
+                if (resimulateFrom < 0 || k < resimulateFrom) resimulateFrom = k;
+                break;
+            }
+    }
+
+    // Goes back to the first mispredicted tick, if any, and simulates up to
+    // the current frame again. advance() does this first.
+    void resimulate() {
+        if (resimulateFrom < 0) return;
+        auto start = std::chrono::steady_clock::now();
+        game = saved[resimulateFrom % Window];
+        copyTime += std::chrono::steady_clock::now() - start;
+        copies++;
+        rollbacks++;
+        int depth = (int)(frame - resimulateFrom);
+        if (depth > deepest) deepest = depth;
+        for (long t = resimulateFrom; t < frame; t++) simulate(t);
+        resimulated += depth;
+        resimulateFrom = -1;
+    }
+
+    // Rolls back if needed, then runs one more tick with local as this
+    // player's input for tick frame + delay. Returns false (and drops the
+    // input) when it is too far ahead of the other player and must wait.
+    bool advance(char localInput) {
+        resimulate();
+        if (frame - confirmed > Window - 1) return false;
+        setInput(local, frame + delay, localInput);
+        localUpTo = frame + delay;
+        simulate(frame);
+        frame++;
+        return true;
+    }
+};
+
+#endif
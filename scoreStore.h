@@ -0,0 +1,253 @@
+// === Score Store ===
+// Keeps every finished game's score without the cost growing with history.
+//
+//   <name>.log  append-only binary log, one fixed-size Record per game
+//   <name>.idx  the best TopK scores, sorted high to low, plus how many log
+//               records they cover
+//
+// add() appends one record and rewrites the small index, so asking for the
+// top N reads at most TopK ints no matter how long the log is. If the index
+// is missing or does not cover the whole log (e.g. a crash between the two
+// writes) it is rebuilt from the log on open. compact() drops log records
+// that can no longer reach the top, keeping the newest ones; addAll() runs
+// it by itself once the log holds more than twice the records it keeps, so
+// the log stays bounded and the rewrite is paid once per keepRecent games.
+// importText() reads the old score.txt format (one score per line).
+// Another process may add scores too; reloadIfChanged() picks them up by
+// checking the index file's modification time. With setDurable(true) each
+// write is fsynced before it counts as done.
+#ifndef SCORE_STORE_H
+#define SCORE_STORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+class ScoreStore {
+public:
+    static constexpr int TopK = 16;
+
+    struct Record {
+        std::int64_t when; // unix time the game ended
+        std::int32_t score;
+        std::int32_t reserved;
+    };
+
+private:
+    static constexpr std::uint32_t LogMagic = 0x474c4e53; // "SNLG"
+    static constexpr std::uint32_t IdxMagic = 0x58494e53; // "SNIX"
+
+    struct IdxHeader {
+        std::uint32_t magic;
+        std::uint32_t count;  // scores that follow
+        std::uint64_t covers; // log records included
+    };
+
+    std::string logPath, idxPath;
+    std::vector<int> best; // top scores, high to low, at most TopK
+    std::uint64_t records = 0;
+    std::uint64_t keepRecent = 1000; // newest records compaction keeps
+    unsigned revision = 0; // bumped whenever best changes
+    bool durable = false;
+    std::filesystem::file_time_type seen{}; // index mtime as of our last read or write
+
+    void noteIndexTime() {
+        std::error_code ec;
+        seen = std::filesystem::last_write_time(idxPath, ec);
+    }
+
+    // rename() over an existing file, which Windows does not allow directly.
+    static bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+        std::remove(to.c_str());
+#endif
+        return std::rename(from.c_str(), to.c_str()) == 0;
+    }
+
+    // Forces a written file to disk. Windows has no cheap equivalent for a
+    // closed fstream, so there it is a no-op.
+    static bool syncFile(const std::string& path) {
+#ifdef _WIN32
+        (void)path;
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+#endif
+    }
+
+    static bool readLogHeader(std::ifstream& in) {
+        std::uint32_t magic = 0;
+        return in.read((char*)&magic, sizeof magic) && magic == LogMagic;
+    }
+
+    void insertBest(int score) {
+        if ((int)best.size() == TopK && score <= best.back()) return;
+        best.insert(std::upper_bound(best.begin(), best.end(), score, std::greater<int>()), score);
+        if ((int)best.size() > TopK) best.pop_back();
+    }
+
+    // Appends records to the log, creating it with its header if needed.
+    bool append(const std::vector<Record>& recs) {
+        bool fresh = !exists();
+        std::ofstream out(logPath, std::ios::binary | std::ios::app);
+        if (!out.is_open()) return false;
+        if (fresh) out.write((const char*)&LogMagic, sizeof LogMagic);
+        out.write((const char*)recs.data(), recs.size() * sizeof(Record));
+        out.close();
+        return !out.fail() && (!durable || syncFile(logPath));
+    }
+
+    bool writeIndex() {
+        std::string tmp = idxPath + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            IdxHeader h = {IdxMagic, (std::uint32_t)best.size(), records};
+            std::vector<std::int32_t> scores(best.begin(), best.end());
+            out.write((const char*)&h, sizeof h);
+            out.write((const char*)scores.data(), scores.size() * sizeof(std::int32_t));
+            if (!out) return false;
+        }
+        if (durable && !syncFile(tmp)) return false;
+        if (!replaceFile(tmp, idxPath)) return false;
+        noteIndexTime();
+        return true;
+    }
+
+    bool readIndex() {
+        std::ifstream in(idxPath, std::ios::binary);
+        IdxHeader h;
+        if (!in.read((char*)&h, sizeof h) || h.magic != IdxMagic || h.count > (std::uint32_t)TopK) return false;
+        std::vector<std::int32_t> scores(h.count);
+        if (!in.read((char*)scores.data(), h.count * sizeof(std::int32_t))) return false;
+        best.assign(scores.begin(), scores.end());
+        records = h.covers;
+        revision++;
+        noteIndexTime();
+        return true;
+    }
+
+    std::uint64_t logRecords() const {
+        std::ifstream in(logPath, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) return 0;
+        std::streamoff size = in.tellg();
+        return size > (std::streamoff)sizeof LogMagic ? (size - sizeof LogMagic) / sizeof(Record) : 0;
+    }
+
+    void rebuild() {
+        best.clear();
+        records = 0;
+        std::ifstream in(logPath, std::ios::binary);
+        if (!in.is_open() || !readLogHeader(in)) return;
+        Record r;
+        while (in.read((char*)&r, sizeof r)) {
+            insertBest(r.score);
+            records++;
+        }
+        revision++;
+        writeIndex();
+    }
+
+public:
+    explicit ScoreStore(const std::string& name = "scores") : logPath(name + ".log"), idxPath(name + ".idx") {
+        if (!readIndex() || records != logRecords()) rebuild();
+    }
+
+    const std::string& indexPath() const { return idxPath; }
+    bool exists() const { return std::ifstream(logPath).is_open(); }
+    std::uint64_t size() const { return records; }
+    unsigned getRevision() const { return revision; }
+    void setDurable(bool on) { durable = on; }
+    void setKeepRecent(std::uint64_t n) { keepRecent = n; }
+
+    // Re-reads the index if some other writer changed it since we last saw
+    // it. Returns true if it did.
+    bool reloadIfChanged() {
+        std::error_code ec;
+        std::filesystem::file_time_type t = std::filesystem::last_write_time(idxPath, ec);
+        if (ec || t == seen) return false;
+        if (!readIndex() || records != logRecords()) rebuild();
+        return true;
+    }
+
+    // Best n scores, high to low (n is capped at TopK).
+    std::vector<int> top(int n) const {
+        return std::vector<int>(best.begin(), best.begin() + std::min<size_t>(std::max(n, 0), best.size()));
+    }
+
+    bool add(int score) { return addAll(std::vector<int>(1, score)); }
+
+    // Appends several scores with one log write and one index update.
+    bool addAll(const std::vector<int>& scores) {
+        if (scores.empty()) return true;
+        std::vector<Record> recs;
+        std::int64_t now = std::time(nullptr);
+        for (int s : scores) recs.push_back(Record{now, s, 0});
+        if (!append(recs)) return false;
+        for (int s : scores) insertBest(s);
+        records += scores.size();
+        revision++;
+        if (!writeIndex()) return false;
+        if (records > 2 * keepRecent + TopK) compact(); // if it fails the log is just left longer
+        return true;
+    }
+
+    // Imports a text file with one score per line.
+    bool importText(const std::string& path) {
+        std::ifstream in(path);
+        if (!in.is_open()) return false;
+        std::vector<int> scores;
+        int s;
+        while (in >> s) scores.push_back(s);
+        return addAll(scores);
+    }
+
+    // Rewrites the log keeping the newest keepRecent records plus the ones
+    // whose scores make up the top list (at most TopK, so a run of equal
+    // scores at the cutoff cannot keep the log long).
+    bool compact() {
+        std::vector<Record> kept;
+        {
+            std::ifstream in(logPath, std::ios::binary);
+            if (!in.is_open() || !readLogHeader(in)) return false;
+            int cutoff = (int)best.size() == TopK ? best.back() : INT32_MIN;
+            int atCutoff = (int)std::count(best.begin(), best.end(), cutoff);
+            std::uint64_t i = 0;
+            Record r;
+            while (in.read((char*)&r, sizeof r)) {
+                bool recent = i + keepRecent >= records;
+                if (recent || r.score > cutoff || (r.score == cutoff && atCutoff-- > 0)) kept.push_back(r);
+                i++;
+            }
+        }
+        std::string tmp = logPath + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) return false;
+            out.write((const char*)&LogMagic, sizeof LogMagic);
+            out.write((const char*)kept.data(), kept.size() * sizeof(Record));
+            if (!out) return false;
+        }
+        if (durable && !syncFile(tmp)) return false;
+        if (!replaceFile(tmp, logPath)) return false;
+        records = kept.size();
+        return writeIndex();
+    }
+};
+
+#endif
@@ -0,0 +1,118 @@
+// === Score Writer ===
+// Saves scores on a background thread so the game loop never waits on the
+// disk. submit() only puts the score in a bounded queue; the writer thread
+// waits a short moment for more scores to arrive and then commits the whole
+// batch with one ScoreStore::addAll (one log append, one index write, and
+// with fsync on, one sync each). The destructor writes whatever is still
+// queued before returning.
+//
+// The store is shared with the game thread, so everything else that touches
+// it goes through withStore (waits for a batch in progress to finish) or
+// tryWithStore (skips if a batch is being written, for use inside a frame).
+#ifndef SCORE_WRITER_H
+#define SCORE_WRITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "scoreStore.h"
+#include "traceEvents.h"
+
+class ScoreWriter {
+    static const size_t Capacity = 256;
+    static const size_t MaxBatch = 64;
+
+    ScoreStore& store;
+    std::mutex storeLock;
+
+    std::mutex queueLock;
+    std::condition_variable wake;    // writer: new score or stop
+    std::condition_variable written; // flush(): queue drained
+    std::deque<int> queue;
+    size_t inFlight = 0; // scores taken from the queue but not yet written
+    size_t failed = 0;   // batches the store could not write
+    bool stopping = false;
+    std::chrono::milliseconds window;
+    std::thread worker;
+
+    void run() {
+        TRACE_THREAD("score writer");
+        std::vector<int> batch;
+        std::unique_lock<std::mutex> lock(queueLock);
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // stopping with nothing left
+            // Group commit: give other scores a moment to join this batch.
+            if (!stopping) wake.wait_for(lock, window, [this] { return stopping || queue.size() >= MaxBatch; });
+            batch.assign(queue.begin(), queue.end());
+            queue.clear();
+            inFlight = batch.size();
+            lock.unlock();
+            bool ok;
+            {
+                std::lock_guard<std::mutex> guard(storeLock);
+                TRACE_SPAN("score write");
+                ok = store.addAll(batch);
+            }
+            lock.lock();
+            if (!ok) failed++;
+            inFlight = 0;
+            written.notify_all();
+        }
+    }
+
+public:
+    explicit ScoreWriter(ScoreStore& s, bool fsync = false, int batchWindowMs = 20)
+        : store(s), window(batchWindowMs) {
+        store.setDurable(fsync);
+        worker = std::thread(&ScoreWriter::run, this);
+    }
+
+    ~ScoreWriter() {
+        {
+            std::lock_guard<std::mutex> lock(queueLock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    // Queues a score. Only waits if Capacity scores are already pending.
+    void submit(int score) {
+        std::unique_lock<std::mutex> lock(queueLock);
+        written.wait(lock, [this] { return queue.size() < Capacity; });
+        queue.push_back(score);
+        wake.notify_one();
+    }
+
+    // Waits until every score submitted so far is written.
+    void flush() {
+        std::unique_lock<std::mutex> lock(queueLock);
+        wake.notify_one();
+        written.wait(lock, [this] { return queue.empty() && inFlight == 0; });
+    }
+
+    size_t getFailures() {
+        std::lock_guard<std::mutex> lock(queueLock);
+        return failed;
+    }
+
+    template <class F>
+    void withStore(F f) {
+        std::lock_guard<std::mutex> guard(storeLock);
+        f(store);
+    }
+
+    template <class F>
+    bool tryWithStore(F f) {
+        std::unique_lock<std::mutex> guard(storeLock, std::try_to_lock);
+        if (!guard.owns_lock()) return false;
+        f(store);
+        return true;
+    }
+};
+
+#endif
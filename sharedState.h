@@ -0,0 +1,335 @@
+// === Shared-Memory State ===
+// Publishes a running game in a named shared-memory segment so that bots in
+// other processes can watch it and play without sockets or serialization,
+// and takes their turns from the same segment.
+//
+// Layout: a header, then the board as one byte per cell (0 empty, 1 wall,
+// 2 body, 3 head, 4 fruit, as in vecEnv.h), then the body as a ring of
+// packed cells (segment i at ring[(head - i) & (capacity - 1)]). The game
+// updates both in place, so a tick writes a handful of bytes whatever the
+// board size; only the first tick of a game rewrites everything.
+//
+// The header's sequence number is a seqlock: the game makes it odd before
+// changing anything and even again afterwards. A reader copies what it
+// needs and keeps the copy only if the number was the same even value
+// before and after; otherwise it tries again. The game never waits for
+// readers. A turn goes the other way as one 64-bit word holding the key
+// and the game and tick the bot was looking at, so a late answer to an
+// older state is recognised as such.
+//
+// The segment is POSIX shared memory (shm_open) or a Windows file mapping;
+// the publisher creates and removes it.
+#ifndef SHARED_STATE_H
+#define SHARED_STATE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "snakeEngine.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A named block of memory shared between processes.
+class SharedMemory {
+    void* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE mapping = nullptr;
+#else
+    std::string path;
+    bool owner = false;
+#endif
+
+public:
+    SharedMemory() {}
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+    ~SharedMemory() { close(); }
+
+    void* data() const { return base; }
+    size_t size() const { return length; }
+
+    // Creates (or replaces) the segment, zero-filled.
+    bool create(const std::string& name, size_t bytes) {
+        close();
+#ifdef _WIN32
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((std::uint64_t)bytes >> 32),
+                                     (DWORD)bytes, ("Local\\" + name).c_str());
+        if (!mapping) return false;
+        base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+#else
+        path = "/" + name;
+        shm_unlink(path.c_str());
+        int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) return false;
+        owner = true;
+        if (ftruncate(fd, (off_t)bytes) == 0) {
+            base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) base = nullptr;
+        }
+        ::close(fd);
+#endif
+        if (!base) close();
+        else length = bytes;
+        return base != nullptr;
+    }
+
+    // Maps an existing segment as a whole.
+    bool open(const std::string& name) {
+        close();
+#ifdef _WIN32
+        mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, ("Local\\" + name).c_str());
+        if (!mapping) return false;
+        base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+        MEMORY_BASIC_INFORMATION info;
+        if (base && VirtualQuery(base, &info, sizeof info)) length = info.RegionSize;
+#else
+        path = "/" + name;
+        int fd = shm_open(path.c_str(), O_RDWR, 0600);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            base = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) base = nullptr;
+            else length = (size_t)st.st_size;
+        }
+        ::close(fd);
+#endif
+        if (!base) close();
+        return base != nullptr;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        if (base) munmap(base, length);
+        if (owner) shm_unlink(path.c_str());
+        owner = false;
+#endif
+        base = nullptr;
+        length = 0;
+    }
+};
+
+struct SharedStateHeader {
+    static constexpr std::uint32_t Magic = 0x48534e53; // "SNSH"
+    static constexpr std::uint32_t Version = 1;
+    enum { Empty = 0, Wall = 1, Body = 2, Head = 3, FruitCell = 4 };
+
+    std::uint32_t magic, version;
+    std::int32_t width, height, capacity;
+    std::uint32_t cellsOffset, ringOffset;
+    alignas(64) std::atomic<std::uint64_t> sequence;
+    // Written by the game under the sequence.
+    std::int64_t tick;
+    std::int32_t game; // counts games, so a reader can tell a new one
+    std::int32_t score, fruit, head, length;
+    char status, dir;
+    // Written by the bot, on its own cache line.
+    alignas(64) std::atomic<std::uint64_t> turn;
+
+    static std::uint64_t turnWord(int game, long tick, char key) {
+        return (std::uint64_t)(game & 0xffffff) << 40 | (std::uint64_t)((tick + 1) & 0xffffffff) << 8 | (unsigned char)key;
+    }
+};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared counters must be lock-free");
+
+// Game side: owns the segment.
+class SharedStatePublisher {
+    SharedMemory memory;
+    SharedStateHeader* h = nullptr;
+    std::uint8_t* cells = nullptr;
+    std::int32_t* ring = nullptr;
+    int mask = 0;
+    long lastTick = -1;
+    std::uint64_t lastTurn = 0;
+
+    template <class B>
+    void rewrite(const BasicEngine<B>& g) {
+        const Occupancy& o = g.arena.getOccupancy();
+        for (int c = 0; c < g.board.cells(); c++) cells[c] = o.isWall(c) ? SharedStateHeader::Wall : SharedStateHeader::Empty;
+        int n = g.snake.size();
+        for (int i = 0; i < n; i++) {
+            ring[(n - 1 - i) & mask] = g.snake.segment(i);
+            cells[g.snake.segment(i)] = i ? SharedStateHeader::Body : SharedStateHeader::Head;
+        }
+        h->head = (n - 1) & mask;
+        h->length = n;
+        h->game++;
+    }
+
+public:
+    // Sized for a width x height board; check isOpen().
+    SharedStatePublisher(const std::string& name, int width, int height) {
+        int capacity = 1;
+        while (capacity < width * height) capacity <<= 1;
+        size_t cellsOffset = (sizeof(SharedStateHeader) + 63) & ~(size_t)63;
+        size_t ringOffset = (cellsOffset + width * height + 63) & ~(size_t)63;
+        if (!memory.create(name, ringOffset + capacity * sizeof(std::int32_t))) return;
+        char* base = (char*)memory.data();
+        h = new (base) SharedStateHeader();
+        h->magic = SharedStateHeader::Magic;
+        h->version = SharedStateHeader::Version;
+        h->width = width;
+        h->height = height;
+        h->capacity = capacity;
+        h->cellsOffset = (std::uint32_t)cellsOffset;
+        h->ringOffset = (std::uint32_t)ringOffset;
+        h->sequence.store(0, std::memory_order_relaxed);
+        h->turn.store(0, std::memory_order_relaxed);
+        cells = (std::uint8_t*)(base + cellsOffset);
+        ring = (std::int32_t*)(base + ringOffset);
+        mask = capacity - 1;
+    }
+
+    bool isOpen() const { return h != nullptr; }
+
+    // Call after every step (and for a new game); does nothing if the game
+    // has not moved on since the last call.
+    template <class B>
+    void publish(const BasicEngine<B>& g) {
+        if (!h || g.width() != h->width || g.height() != h->height) return;
+        if (g.ticks == lastTick && g.ticks != 0) return;
+        std::uint64_t seq = h->sequence.load(std::memory_order_relaxed);
+        h->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (g.ticks == 0 || g.ticks != lastTick + 1) rewrite(g);
+        else if (g.snake.segment(0) != ring[h->head]) { // moved (a blocked move does not)
+            cells[ring[h->head]] = SharedStateHeader::Body;
+            h->head = (h->head + 1) & mask;
+            ring[h->head] = g.snake.segment(0);
+            if (g.snake.size() == h->length) cells[ring[(h->head - h->length) & mask]] = SharedStateHeader::Empty;
+            cells[ring[h->head]] = SharedStateHeader::Head;
+            h->length = g.snake.size();
+        }
+        const std::vector<int>& fp = g.fruit.getPos();
+        int fruit = g.board.pack(fp[0], fp[1]);
+        if (g.status != 'W') {
+            if (cells[h->fruit] == SharedStateHeader::FruitCell) cells[h->fruit] = SharedStateHeader::Empty;
+            cells[fruit] = SharedStateHeader::FruitCell;
+        }
+        h->fruit = fruit;
+        h->tick = g.ticks;
+        h->score = g.score.getScore();
+        h->status = g.status;
+        h->dir = g.snake.checkDir();
+        lastTick = g.ticks;
+
+        h->sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // The bot's latest turn if it has sent a new one since the last call,
+    // else 0.
+    char turn() {
+        if (!h) return 0;
+        std::uint64_t t = h->turn.load(std::memory_order_acquire);
+        if (t == lastTurn) return 0;
+        lastTurn = t;
+        return (char)(t & 0xff);
+    }
+
+    // Lockstep: waits until the bot has answered the last published state
+    // and returns its key (0 to keep going), or -1 after timeout.
+    int waitTurn(std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::uint64_t want = SharedStateHeader::turnWord(h->game, (long)h->tick, 0) >> 8;
+        for (int spins = 0;; spins++) {
+            std::uint64_t t = h->turn.load(std::memory_order_acquire);
+            if (t >> 8 == want) {
+                lastTurn = t;
+                return (char)(t & 0xff);
+            }
+            if ((spins & 1023) == 1023 && std::chrono::steady_clock::now() > deadline) return -1;
+            std::this_thread::yield();
+        }
+    }
+};
+
+// Bot side: a consistent copy of the published state.
+struct SharedStateView {
+    int width = 0, height = 0;
+    long tick = -1;
+    int game = 0, score = 0, fruit = 0;
+    char status = 'G', dir = 'w';
+    std::vector<std::uint8_t> cells;
+    std::vector<int> body; // head first
+};
+
+class SharedStateReader {
+    SharedMemory memory;
+    SharedStateHeader* h = nullptr;
+    const std::uint8_t* cells = nullptr;
+    const std::int32_t* ring = nullptr;
+    std::uint64_t seen = 1; // odd: nothing read yet
+
+public:
+    bool open(const std::string& name) {
+        if (!memory.open(name) || memory.size() < sizeof(SharedStateHeader)) return false;
+        h = (SharedStateHeader*)memory.data();
+        if (h->magic != SharedStateHeader::Magic || h->version != SharedStateHeader::Version ||
+            memory.size() < h->ringOffset + h->capacity * sizeof(std::int32_t)) {
+            h = nullptr;
+            return false;
+        }
+        cells = (const std::uint8_t*)memory.data() + h->cellsOffset;
+        ring = (const std::int32_t*)((const char*)memory.data() + h->ringOffset);
+        return true;
+    }
+
+    // True if the game has published something the last read() did not see.
+    bool changed() const { return h->sequence.load(std::memory_order_acquire) != seen; }
+
+    // Copies the current state into v; spins while the game is writing.
+    void read(SharedStateView& v) {
+        int mask = h->capacity - 1;
+        for (;;) {
+            std::uint64_t before = h->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            v.width = h->width;
+            v.height = h->height;
+            v.tick = (long)h->tick;
+            v.game = h->game;
+            v.score = h->score;
+            v.fruit = h->fruit;
+            v.status = h->status;
+            v.dir = h->dir;
+            int head = h->head, length = h->length;
+            if (length < 0 || length > h->capacity) length = 0; // torn; checked below
+            v.cells.resize((size_t)v.width * v.height);
+            std::memcpy(v.cells.data(), cells, v.cells.size());
+            v.body.resize(length);
+            for (int i = 0; i < length; i++) v.body[i] = ring[(head - i) & mask];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (h->sequence.load(std::memory_order_relaxed) == before) {
+                seen = before;
+                return;
+            }
+        }
+    }
+
+    // key is 'w', 'a', 's', 'd' or 0 to keep going, in answer to state v.
+    void sendTurn(const SharedStateView& v, char key) {
+        h->turn.store(SharedStateHeader::turnWord(v.game, v.tick, key), std::memory_order_release);
+    }
+};
+
+#endif
@@ -0,0 +1,235 @@
+// === Headless Benchmark ===
+// Plays games on the engine with no window and no console output per tick,
+// as fast as the CPU allows, then reports ticks per second.
+//
+//   snakeBench [-n games] [-a arena] [-s seed] [-m moves] [-W width] [-H height]
+//              [-b budget] [-j threads] [-e envs] [-o 0|1] [-p players]
+//              [-x name]
+//
+// arena is 1=Classic, 2=Boundary, 3=Complex as in the SFML menu. Without
+// moves every tick gets a random key; otherwise the string is played in a
+// loop ('w', 'a', 's', 'd' turn, anything else keeps going straight).
+// "-m auto" lets the autopilot play, which gives long games with long snakes,
+// "-m cycle" the Hamiltonian cycle solver, which fills the board, and
+// "-m mcts" the Monte Carlo tree search bot with budget ms per move (20) on
+// threads workers (one per core); it also reports rollout throughput. A game
+// a bot plays (here or through -x) is stopped if it goes 8 x cells ticks
+// without eating.
+// -e runs envs games side by side on the vectorized API (vecEnv.h) with
+// random actions on threads workers until games episodes have finished;
+// -o 1 also writes board observations every step.
+// -p puts players bot snakes on one shared board (multiSnake.h) for games
+// ticks, respawning the dead, with one fruit per two snakes; it reports
+// heads moved per second.
+// -x publishes the games in shared memory under name (sharedState.h) and
+// plays each tick with the key an outside bot (snakeShmBot) answers; it
+// gives up if the bot takes more than 2 seconds.
+// 20x20, 32x32, 64x64 and 256x256 boards run on the compile-time FixedBoard
+// path, any other size (up to 4096x4096) on the runtime Board.
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include "snakeEngine.h"
+#include "hamiltonCycle.h"
+#include "mctsBot.h"
+#include "vecEnv.h"
+#include "multiSnake.h"
+#include "sharedState.h"
+using namespace std;
+
+struct BenchOptions {
+    long games = 100000;
+    int mode = 1;
+    unsigned seed = 1;
+    string moves;
+    int width = 20, height = 20;
+    int budget = 20;
+    unsigned threads = thread::hardware_concurrency();
+    int envs = 0;
+    bool observe = false;
+    int players = 0;
+    string shared;
+};
+
+void runMulti(const BenchOptions& opt) {
+    MultiSnakeArena arena(makeArena(opt.mode, opt.width, opt.height), max(1, opt.players / 2), opt.seed);
+    for (int i = 0; i < opt.players; i++) arena.spawn();
+    long heads = 0, respawns = 0;
+    int longest = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (long t = 0; t < opt.games; t++) {
+        for (int id : arena.alive()) arena.steerBot(id);
+        heads += arena.alive().size();
+        if (arena.step() == 0) continue;
+        for (int id = 0; id < arena.playerCount(); id++)
+            if (!arena.player(id).alive) {
+                longest = max(longest, arena.player(id).length());
+                respawns += arena.spawn(id) >= 0;
+            }
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    for (int id : arena.alive()) longest = max(longest, arena.player(id).length());
+
+    cout << "board: " << opt.width << "x" << opt.height << " (runtime), " << arena.playerCount() << " snakes" << endl;
+    cout << "ticks: " << arena.ticks() << "  heads moved: " << heads << "  time: " << secs << " s" << endl;
+    cout << "heads/s: " << (secs > 0 ? heads / secs : 0) << "  ticks/s: " << (secs > 0 ? arena.ticks() / secs : 0) << endl;
+    cout << "deaths: " << arena.totalDeaths() << "  respawns: " << respawns << "  longest: " << longest << endl;
+}
+
+template <class B>
+void runVec(const BenchOptions& opt, const char* boardKind) {
+    BasicVecEnv<B> env(opt.envs, makeArena(opt.mode, opt.width, opt.height), opt.seed, opt.threads);
+    int n = env.size();
+    vector<int8_t> actions(n);
+    vector<float> rewards(n);
+    vector<uint8_t> dones(n);
+    vector<uint8_t> obs(opt.observe ? (size_t)n * env.observationSize() : 0);
+    mt19937 keys(opt.seed);
+    long episodes = 0, steps = 0, totalScore = 0;
+
+    auto start = chrono::steady_clock::now();
+    while (episodes < opt.games) {
+        for (int i = 0; i < n; i++) actions[i] = keys() & 3;
+        env.step(actions.data(), rewards.data(), dones.data(), opt.observe ? obs.data() : nullptr);
+        steps += n;
+        for (int i = 0; i < n; i++)
+            if (dones[i]) {
+                episodes++;
+                totalScore += env.finalScore(i);
+            }
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "board: " << opt.width << "x" << opt.height << " (" << boardKind << "), " << n << " envs, "
+         << opt.threads << " threads" << (opt.observe ? ", observations" : "") << endl;
+    cout << "episodes: " << episodes << "  steps: " << steps << "  time: " << secs << " s" << endl;
+    cout << "steps/s: " << (secs > 0 ? steps / secs : 0) << endl;
+    cout << "avg score: " << (episodes ? (double)totalScore / episodes : 0) << endl;
+}
+
+template <class B>
+void run(const BenchOptions& opt, const char* boardKind) {
+    Arena arena = makeArena(opt.mode, opt.width, opt.height);
+
+    mt19937 keys(opt.seed);
+    const char turns[4] = {'w', 'a', 's', 'd'};
+    long ticks = 0, totalScore = 0;
+    int maxScore = 0;
+    long ends[4] = {0, 0, 0, 0}; // b, s, W, stalled
+    bool useCycle = opt.moves == "cycle", useMcts = opt.moves == "mcts";
+    bool useAutopilot = useCycle || useMcts || opt.moves == "auto";
+    Autopilot pilot;
+    CycleSolver solver;
+    unique_ptr<MctsBot> bot(useMcts ? new MctsBot(opt.budget, 40, opt.threads) : nullptr);
+    unique_ptr<SharedStatePublisher> outside;
+    if (!opt.shared.empty()) {
+        outside.reset(new SharedStatePublisher(opt.shared, opt.width, opt.height));
+        if (!outside->isOpen()) {
+            cerr << "cannot create shared memory " << opt.shared << endl;
+            return;
+        }
+    }
+    bool watchStalls = useAutopilot || outside;
+    const long stallTicks = 8L * opt.width * opt.height;
+
+    auto start = chrono::steady_clock::now();
+    long played = 0;
+    bool gaveUp = false;
+    for (long g = 0; g < opt.games && !gaveUp; g++) {
+        BasicEngine<B> game(arena, opt.seed + g);
+        if (useCycle && g == 0 && !solver.ready(game)) cout << "no Hamiltonian cycle for this arena, using the autopilot" << endl;
+        size_t next = 0;
+        char result = 'G';
+        long lastMeal = 0;
+        int lastScore = 0;
+        while (result == 'G') {
+            char key;
+            if (outside) {
+                outside->publish(game);
+                int answer = outside->waitTurn(chrono::milliseconds(2000));
+                if (answer < 0) {
+                    cerr << "no answer from the bot" << endl;
+                    gaveUp = true;
+                    break;
+                }
+                key = (char)answer;
+            } else if (useMcts) key = bot->decide(game);
+            else if (useCycle) key = solver.decide(game);
+            else if (useAutopilot) key = pilot.decide(game);
+            else if (opt.moves.empty()) key = turns[keys() & 3];
+            else {
+                key = opt.moves[next];
+                if (++next == opt.moves.size()) next = 0;
+            }
+            result = game.step(key);
+            if (watchStalls && game.score.getScore() != lastScore) {
+                lastScore = game.score.getScore();
+                lastMeal = game.ticks;
+            } else if (watchStalls && game.ticks - lastMeal > stallTicks) break;
+        }
+        if (gaveUp) break;
+        played++;
+        ticks += game.ticks;
+        totalScore += game.score.getScore();
+        if (game.score.getScore() > maxScore) maxScore = game.score.getScore();
+        ends[result == 'b' ? 0 : result == 's' ? 1 : result == 'W' ? 2 : 3]++;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "board: " << opt.width << "x" << opt.height << " (" << boardKind << ")" << endl;
+    cout << "games: " << played << "  ticks: " << ticks << "  time: " << secs << " s" << endl;
+    cout << "ticks/s: " << (secs > 0 ? ticks / secs : 0) << endl;
+    cout << "avg score: " << (played ? (double)totalScore / played : 0) << "  max score: " << maxScore << endl;
+    cout << "ends: block " << ends[0] << ", self " << ends[1] << ", board full " << ends[2];
+    if (watchStalls) cout << ", stalled " << ends[3];
+    cout << endl;
+    if (useMcts)
+        cout << "mcts: " << bot->threads() << " threads, " << bot->rollouts() / secs << " rollouts/s, "
+             << bot->steps() / secs << " rollout steps/s" << endl;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-n")) opt.games = atol(argv[i + 1]);
+        else if (!strcmp(argv[i], "-a")) opt.mode = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-s")) opt.seed = strtoul(argv[i + 1], nullptr, 10);
+        else if (!strcmp(argv[i], "-m")) opt.moves = argv[i + 1];
+        else if (!strcmp(argv[i], "-W")) opt.width = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-H")) opt.height = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-b")) opt.budget = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-j")) opt.threads = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-e")) opt.envs = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-o")) opt.observe = atoi(argv[i + 1]) != 0;
+        else if (!strcmp(argv[i], "-p")) opt.players = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-x")) opt.shared = argv[i + 1];
+        else {
+            cerr << "unknown option " << argv[i] << endl;
+            return 1;
+        }
+    }
+    if (opt.width < 8 || opt.height < 8 || opt.width > Board::maxSide || opt.height > Board::maxSide) {
+        cerr << "board sides must be between 8 and " << Board::maxSide << endl;
+        return 1;
+    }
+
+    if (opt.players > 0) {
+        runMulti(opt);
+        return 0;
+    }
+    if (opt.envs > 0) {
+        if (opt.width == 20 && opt.height == 20) runVec<FixedBoard<20, 20>>(opt, "fixed");
+        else runVec<Board>(opt, "runtime");
+        return 0;
+    }
+    if (opt.width == 20 && opt.height == 20) run<FixedBoard<20, 20>>(opt, "fixed");
+    else if (opt.width == 32 && opt.height == 32) run<FixedBoard<32, 32>>(opt, "fixed, pow2");
+    else if (opt.width == 64 && opt.height == 64) run<FixedBoard<64, 64>>(opt, "fixed, pow2");
+    else if (opt.width == 256 && opt.height == 256) run<FixedBoard<256, 256>>(opt, "fixed, pow2");
+    else run<Board>(opt, "runtime");
+    return 0;
+}
@@ -0,0 +1,134 @@
+// === Bot Client ===
+// Load and test client for snakeServer: opens any number of connections
+// from one process, keeps a copy of each game from the server's deltas and
+// plays it with a simple bot that heads for the fruit and avoids walls and
+// its own body.
+//
+//   snakeClient [-h host] [-p port] [-n connections] [-t seconds]
+//
+// At the end it prints the ticks and games it saw, the bytes it received
+// per tick and game, and how many deltas or keyframes disagreed with its
+// copy (0 unless something is broken).
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include "netProtocol.h"
+#include "netSocket.h"
+using namespace std;
+
+struct Connection {
+    TcpSocket socket;
+    NetMirror game;
+    string in;
+    long seenTick = -1;
+    long seenGames = 0;
+};
+
+// Distance along one axis on the wrap-around board.
+static int wrapDistance(int a, int b, int size) {
+    int d = a > b ? a - b : b - a;
+    return d < size - d ? d : size - d;
+}
+
+// The open move that gets closest to the fruit, ties broken at random, or 0
+// to keep going straight.
+static char decide(const NetMirror& g, mt19937& rng) {
+    const char dirs[4] = {'w', 'a', 's', 'd'};
+    const Board& board = g.getBoard();
+    int head = g.body.front(), best = -1, bestDistance = 0, current = -1;
+    int back = g.body[1]; // the engine's snakes are never shorter than 3
+    for (int d = 0; d < 4; d++)
+        if (board.next(back, d) == head) current = d;
+    int fx = board.cellX(g.fruit), fy = board.cellY(g.fruit);
+    int first = rng() & 3;
+    for (int k = 0; k < 4; k++) {
+        int d = (first + k) & 3;
+        int c = board.next(head, d);
+        if (c == back || !g.isOpen(c)) continue;
+        int distance = wrapDistance(board.cellX(c), fx, g.getWidth()) + wrapDistance(board.cellY(c), fy, g.getHeight());
+        if (best < 0 || distance < bestDistance) best = d, bestDistance = distance;
+    }
+    return best < 0 || best == current ? 0 : dirs[best];
+}
+
+int main(int argc, char** argv) {
+    string host = "127.0.0.1";
+    int port = 7777, count = 100;
+    long seconds = 10;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-h")) host = argv[i + 1];
+        else if (!strcmp(argv[i], "-p")) port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-n")) count = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-t")) seconds = atol(argv[i + 1]);
+        else {
+            cerr << "unknown option " << argv[i] << endl;
+            return 1;
+        }
+    }
+
+    vector<unique_ptr<Connection>> conns;
+    for (int i = 0; i < count; i++) {
+        unique_ptr<Connection> c(new Connection);
+        c->socket = TcpSocket::connect(host, port);
+        if (!c->socket.isOpen()) {
+            cerr << "cannot connect to " << host << ":" << port << " (" << i << " connected)" << endl;
+            return 1;
+        }
+        conns.push_back(move(c));
+    }
+
+    mt19937 rng(1);
+    char buffer[4096];
+    long bytes = 0, errors = 0;
+    auto start = chrono::steady_clock::now();
+    while (chrono::steady_clock::now() - start < chrono::seconds(seconds)) {
+        bool idle = true;
+        for (auto& c : conns) {
+            if (!c->socket.isOpen()) continue;
+            int n;
+            while ((n = c->socket.receive(buffer, sizeof buffer)) > 0) {
+                c->in.append(buffer, n);
+                bytes += n;
+                idle = false;
+            }
+            if (n < 0) {
+                c->socket.close();
+                continue;
+            }
+            size_t at = 0;
+            int used;
+            while ((used = c->game.apply(c->in.data() + at, c->in.size() - at)) > 0) at += used;
+            c->in.erase(0, at);
+            if (used < 0) {
+                errors++;
+                c->socket.close();
+                continue;
+            }
+            NetMirror& g = c->game;
+            if (!g.started || g.status != 'G' || (g.ticks == c->seenTick && g.games == c->seenGames)) continue;
+            c->seenTick = g.ticks;
+            c->seenGames = g.games;
+            char key = decide(g, rng);
+            if (key) c->socket.send(&key, 1);
+        }
+        if (idle) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    long games = 0, ticks = 0, mismatches = 0, open = 0;
+    for (auto& c : conns) {
+        games += c->game.games;
+        ticks += c->game.deltas;
+        mismatches += c->game.mismatches;
+        open += c->socket.isOpen();
+    }
+    cout << "connections: " << count << " (" << open << " still open)  games: " << games << "  ticks: " << ticks << endl;
+    cout << "bytes/tick/game: " << (ticks ? (double)bytes / ticks : 0) << "  mismatches: " << mismatches
+         << "  bad messages: " << errors << endl;
+    return mismatches || errors ? 1 : 0;
+}
@@ -0,0 +1,415 @@
+// === Snake Engine ===
+// Headless game rules shared by the SFML and console front ends. Nothing in
+// here does any I/O: a front end builds an Engine for an arena, feeds it one
+// input per tick with step() and draws whatever state it likes afterwards.
+// A game is fully determined by its arena, its seed and the turns taken, so
+// the same inputs give the same game on every platform (see replay.h).
+#ifndef SNAKE_ENGINE_H
+#define SNAKE_ENGINE_H
+
+#include <vector>
+#include <array>
+#include <random>
+#include <cstdint>
+#include <cassert>
+#include "traceEvents.h"
+
+// Directions are indexed w, a, s, d in neighbor tables.
+inline int dirIndex(char d) {
+    switch (d) {
+        case 'w': return 0;
+        case 'a': return 1;
+        case 's': return 2;
+        default: return 3;
+    }
+}
+
+// Runtime board geometry for any size up to 4096x4096. Cells are packed as
+// y * width + x. Boards up to 1M cells get a precomputed wrap-around
+// neighbor table; larger power-of-two boards wrap with masks and the rest
+// fall back to arithmetic.
+class Board {
+    std::vector<int> neighbors; // 4 per cell, w a s d
+    bool pow2;
+public:
+    static const int maxSide = 4096;
+    static const int maxTableCells = 1 << 20;
+    int width, height;
+
+    Board(int w = 20, int h = 20) : width(w), height(h) {
+        pow2 = (w & (w - 1)) == 0 && (h & (h - 1)) == 0;
+        if (cells() > maxTableCells) return;
+        neighbors.resize(cells() * 4);
+        for (int c = 0; c < cells(); c++)
+            for (int d = 0; d < 4; d++)
+                neighbors[c * 4 + d] = wrap(c, d);
+    }
+    int cells() const { return width * height; }
+    int pack(int x, int y) const { return y * width + x; }
+    int cellX(int cell) const { return cell % width; }
+    int cellY(int cell) const { return cell / width; }
+    int next(int cell, int d) const {
+        if (!neighbors.empty()) return neighbors[cell * 4 + d];
+        if (pow2) {
+            int row = cell & ~(width - 1);
+            switch (d) {
+                case 0: return (cell - width) & (cells() - 1);
+                case 1: return row | ((cell - 1) & (width - 1));
+                case 2: return (cell + width) & (cells() - 1);
+                default: return row | ((cell + 1) & (width - 1));
+            }
+        }
+        return wrap(cell, d);
+    }
+private:
+    int wrap(int cell, int d) const {
+        int x = cell % width, y = cell / width;
+        switch (d) {
+            case 0: y = y == 0 ? height - 1 : y - 1; break;
+            case 1: x = x == 0 ? width - 1 : x - 1; break;
+            case 2: y = y == height - 1 ? 0 : y + 1; break;
+            default: x = x == width - 1 ? 0 : x + 1; break;
+        }
+        return y * width + x;
+    }
+};
+
+// Compile-time board for common sizes. Power-of-two sides wrap with masks,
+// other sizes use a neighbor table built at compile time.
+template <int W, int H>
+class FixedBoard {
+    static constexpr std::array<int, W * H * 4> makeTable() {
+        std::array<int, W * H * 4> t{};
+        for (int c = 0; c < W * H; c++) {
+            int x = c % W, y = c / W;
+            t[c * 4 + 0] = (y == 0 ? H - 1 : y - 1) * W + x;
+            t[c * 4 + 1] = y * W + (x == 0 ? W - 1 : x - 1);
+            t[c * 4 + 2] = (y == H - 1 ? 0 : y + 1) * W + x;
+            t[c * 4 + 3] = y * W + (x == W - 1 ? 0 : x + 1);
+        }
+        return t;
+    }
+public:
+    static constexpr int width = W, height = H;
+    static constexpr bool pow2 = (W & (W - 1)) == 0 && (H & (H - 1)) == 0;
+
+    FixedBoard(int w = W, int h = H) { assert(w == W && h == H); (void)w; (void)h; }
+    static constexpr int cells() { return W * H; }
+    static constexpr int pack(int x, int y) { return y * W + x; }
+    static constexpr int cellX(int cell) { return cell % W; }
+    static constexpr int cellY(int cell) { return cell / W; }
+    static int next(int cell, int d) {
+        if constexpr (pow2) {
+            int row = cell & ~(W - 1);
+            switch (d) {
+                case 0: return (cell - W) & (W * H - 1);
+                case 1: return row | ((cell - 1) & (W - 1));
+                case 2: return (cell + W) & (W * H - 1);
+                default: return row | ((cell + 1) & (W - 1));
+            }
+        } else {
+            static constexpr std::array<int, W * H * 4> table = makeTable();
+            return table[cell * 4 + d];
+        }
+    }
+};
+
+// Bit per board cell for each layer, so a collision is a single bit test.
+// Unoccupied cells are also kept in a swap-remove array with a position
+// index, so a random free cell is picked in constant time.
+class Occupancy {
+    int width, height;
+    std::vector<uint64_t> walls, body, fruit;
+    std::vector<int> freeCells;
+    std::vector<int> freeIndex; // slot in freeCells, -1 when occupied
+    int freeCount;
+    static bool test(const std::vector<uint64_t>& bits, int cell) { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+    static void set(std::vector<uint64_t>& bits, int cell) { bits[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    static void clear(std::vector<uint64_t>& bits, int cell) { bits[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+    void take(int cell) {
+        int i = freeIndex[cell];
+        if (i < 0) return;
+        int last = freeCells[--freeCount];
+        freeCells[i] = last;
+        freeIndex[last] = i;
+        freeIndex[cell] = -1;
+    }
+    void release(int cell) {
+        if (freeIndex[cell] >= 0 || isWall(cell) || isBody(cell) || isFruit(cell)) return;
+        freeIndex[cell] = freeCount;
+        freeCells[freeCount++] = cell;
+    }
+public:
+    Occupancy(int w = 20, int h = 20)
+        : width(w), height(h), walls((w * h + 63) / 64), body(walls.size()), fruit(walls.size()),
+          freeCells(w * h), freeIndex(w * h), freeCount(w * h) {
+        for (int i = 0; i < freeCount; i++) freeCells[i] = freeIndex[i] = i;
+    }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    bool isWall(int cell) const { return test(walls, cell); }
+    bool isBody(int cell) const { return test(body, cell); }
+    bool isFruit(int cell) const { return test(fruit, cell); }
+    void setWall(int cell) { set(walls, cell); take(cell); }
+    void setBody(int cell) { set(body, cell); take(cell); }
+    void clearBody(int cell) { clear(body, cell); release(cell); }
+    void setFruit(int cell) { set(fruit, cell); take(cell); }
+    void clearFruit(int cell) { clear(fruit, cell); release(cell); }
+    int getFreeCount() const { return freeCount; }
+    int getFreeCell(int i) const { return freeCells[i]; }
+};
+
+class Fruit {
+    std::vector<int> position;
+    std::mt19937 gen;
+public:
+    int fruitType;
+    Fruit(int x = 9, int y = 9, int type = 1, unsigned seed = 1)
+        : position({x, y}), gen(seed), fruitType(type) {}
+    const std::vector<int>& getPos() const { return position; }
+    // Moves the fruit marker only; the caller keeps the occupancy in step.
+    void setPos(int x, int y) { position[0] = x; position[1] = y; }
+    // Returns false when no free cell is left, i.e. the board is full.
+    bool changeFruitPos(Occupancy& o) {
+        TRACE_SPAN("fruit respawn");
+        if (o.getFreeCount() == 0) return false;
+        // Scaled rather than uniform_int_distribution, whose output differs
+        // between standard libraries and would break replays.
+        int cell = o.getFreeCell((int)((std::uint64_t)(std::uint32_t)gen() * o.getFreeCount() >> 32));
+        position = {cell % o.getWidth(), cell / o.getWidth()};
+        o.setFruit(cell);
+        return true;
+    }
+    void setFruitType(int type) { fruitType = type; }
+    int getFruitType() const { return fruitType; }
+};
+
+class Score {
+    int score;
+public:
+    Score() : score(0) {}
+    Score operator++(int) { score++; return *this; }
+    Score operator+=(int value) { score += value; return *this; }
+    int getScore() const { return score; }
+};
+
+class Block {
+    std::vector<int> position;
+public:
+    Block(int x, int y) : position({x, y}) {}
+    bool checkIfHit(std::vector<int> pos) const { return position == pos; }
+    std::vector<int> getPosition() const { return position; }
+};
+
+// The first fruit goes on (w/2-1, h/2-1) as on the original 20x20 board,
+// except on boards 8 to 13 high, where that is one of the starting snake's
+// cells (x = w/2-1, y = 3..5); there it goes just below the tail instead.
+inline int startFruitY(int h) {
+    int y = h / 2 - 1;
+    return y >= 3 && y <= 5 ? 6 : y;
+}
+
+// Body is a ring buffer of packed cells (y * width + x): a move writes the
+// new head and advances the tail index, so a tick costs the same at any length.
+class Snake {
+    std::vector<int> body; // power-of-two capacity >= board cells
+    int mask;
+    int width;
+    int head, tail;
+    int growth;
+public:
+    char dir;
+    Snake(int w = 20, int h = 20) : width(w), head(2), tail(0), growth(0), dir('w') {
+        int capacity = 1;
+        while (capacity < w * h) capacity <<= 1;
+        body.resize(capacity);
+        mask = capacity - 1;
+        for (int i = 0; i < 3; i++)
+            body[2 - i] = pack(w / 2 - 1, 3 + i);
+    }
+    int pack(int x, int y) const { return y * width + x; }
+    int size() const { return ((head - tail) & mask) + 1; }
+    int capacity() const { return mask + 1; }
+    // Ring indices, growth and heading, for trying moves and taking them
+    // back (mctsBot.h). A move only writes the ring slot after the head, so
+    // rewinding to a mark restores the snake as long as fewer than
+    // capacity() - size() moves were made since; the occupancy is the
+    // caller's to restore.
+    struct Mark {
+        int head, tail, growth;
+        char dir;
+    };
+    Mark mark() const { return Mark{head, tail, growth, dir}; }
+    void rewind(const Mark& m) { head = m.head; tail = m.tail; growth = m.growth; dir = m.dir; }
+    int segment(int i) const { return body[(head - i) & mask]; }
+    int segmentX(int i) const { return segment(i) % width; }
+    int segmentY(int i) const { return segment(i) / width; }
+    char checkDir() const { return dir; }
+    std::vector<int> checkHead() const { return {segmentX(0), segmentY(0)}; }
+    void increaseSnakeSize() { growth++; }
+    void occupy(Occupancy& o) const {
+        for (int i = 0; i < size(); i++)
+            o.setBody(segment(i));
+    }
+    template <class B>
+    char move(const B& board, char position, Fruit& f, Score& s, Occupancy& o) {
+        int cell = board.next(segment(0), dirIndex(position));
+        {
+            TRACE_SPAN("collision");
+            if (o.isWall(cell)) return 'b';
+            if (o.isBody(cell)) return 's';
+        }
+
+        dir = position;
+
+        bool ate = o.isFruit(cell);
+        if (ate) increaseSnakeSize();
+
+        head = (head + 1) & mask;
+        body[head] = cell;
+        o.setBody(cell);
+        if (growth > 0) growth--;
+        else {
+            o.clearBody(body[tail]);
+            tail = (tail + 1) & mask;
+        }
+
+        if (ate) {
+            o.clearFruit(cell);
+            s++;
+            if (!f.changeFruitPos(o)) return 'W';
+        }
+
+        return 'G';
+    }
+};
+
+// Layouts scale with the board; the 20x20 versions are the originals.
+class Arena {
+protected:
+    int width, height;
+    std::vector<Block> blocks;
+    Occupancy occupancy;
+    void addBlock(int x, int y) {
+        blocks.push_back(Block(x, y));
+        occupancy.setWall(y * width + x);
+    }
+public:
+    Arena(int w = 20, int h = 20) : width(w), height(h), occupancy(w, h) {}
+    virtual ~Arena() {}
+    virtual void resetArena() { blocks.clear(); occupancy = Occupancy(width, height); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    std::vector<Block>& getBlocks() { return blocks; }
+    const std::vector<Block>& getBlocks() const { return blocks; }
+    Occupancy& getOccupancy() { return occupancy; }
+    const Occupancy& getOccupancy() const { return occupancy; }
+};
+
+class Classic : public Arena {
+public:
+    Classic(int w = 20, int h = 20) : Arena(w, h) { resetArena(); }
+};
+
+class Complex : public Arena {
+public:
+    Complex(int w = 20, int h = 20) : Arena(w, h) {
+        resetArena();
+        for (int i = 0; i < h; i++) {
+            addBlock(0, i);
+            addBlock(w - 1, i);
+        }
+        for (int i = 1; i < w - 1; i++) {
+            addBlock(i, 0);
+            addBlock(i, h - 1);
+        }
+    }
+};
+
+class Boundary : public Arena {
+public:
+    Boundary(int w = 20, int h = 20) : Arena(w, h) {
+        resetArena();
+        for (int i = w / 5; i < 2 * w / 5; i++)
+            for (int j = h / 5; j < 2 * h / 5; j++)
+                addBlock(i, j);
+        for (int i = w / 5; i < 2 * w / 5; i++)
+            for (int j = 3 * h / 5; j < 4 * h / 5; j++)
+                addBlock(i, j);
+        for (int i = 3 * w / 5; i < 4 * w / 5; i++)
+            for (int j = h / 5; j < 2 * h / 5; j++)
+                addBlock(i, j);
+        for (int i = 3 * w / 5; i < 4 * w / 5; i++)
+            for (int j = 3 * h / 5; j < 4 * h / 5; j++)
+                addBlock(i, j);
+    }
+};
+
+// Arena by menu number: 1 Classic, 2 Boundary, 3 Complex.
+inline Arena makeArena(int mode, int w, int h) {
+    if (mode == 2) return Boundary(w, h);
+    if (mode == 3) return Complex(w, h);
+    return Classic(w, h);
+}
+
+// A turn the snake actually took, at the tick (0-based step number) it was
+// taken. With the seed and arena this is all a replay has to store.
+struct TurnEvent {
+    long tick;
+    char dir;
+};
+
+// Full game state: arena, snake, fruit and score, advanced one tick at a time.
+// step() returns the same event codes as Snake::move: 'G' game continues,
+// 'b' hit a block, 's' hit itself, 'W' board is full. Once the game has ended
+// further steps return the final code without changing the state.
+// B is Board for any size or a FixedBoard<W, H> matching the arena.
+// The seed drives fruit placement; front ends pick one (e.g. random_device)
+// and keep it if they want to record the game. If turnLog is set, each
+// turn is appended to it.
+template <class B>
+class BasicEngine {
+public:
+    B board;
+    Arena arena;
+    Snake snake;
+    Fruit fruit;
+    Score score;
+    long ticks = 0;
+    char status = 'G';
+    std::vector<TurnEvent>* turnLog = nullptr;
+
+    BasicEngine(const Arena& a, unsigned seed)
+        : board(a.getWidth(), a.getHeight()), arena(a), snake(a.getWidth(), a.getHeight()),
+          fruit(a.getWidth() / 2 - 1, startFruitY(a.getHeight()), 1, seed) {
+        Occupancy& o = arena.getOccupancy();
+        snake.occupy(o);
+        auto fpos = fruit.getPos();
+        o.setFruit(board.pack(fpos[0], fpos[1]));
+    }
+
+    int width() const { return arena.getWidth(); }
+    int height() const { return arena.getHeight(); }
+
+    static bool isTurn(char c) { return c == 'w' || c == 'a' || c == 's' || c == 'd'; }
+    static bool isReverse(char a, char b) {
+        return (a == 'w' && b == 's') || (a == 's' && b == 'w') ||
+               (a == 'a' && b == 'd') || (a == 'd' && b == 'a');
+    }
+
+    // Anything that is not a legal turn (no key, a reversal) keeps the current heading.
+    char step(char input) {
+        if (status != 'G') return status;
+        TRACE_SPAN("tick");
+        char d = snake.checkDir();
+        if (!isTurn(input) || isReverse(d, input)) input = d;
+        else if (input != d && turnLog) turnLog->push_back(TurnEvent{ticks, input});
+        ticks++;
+        status = snake.move(board, input, fruit, score, arena.getOccupancy());
+        return status;
+    }
+};
+
+typedef BasicEngine<Board> Engine;
+
+#endif
@@ -0,0 +1,40 @@
+// === Headless Replay Player ===
+// Re-simulates replay files as fast as the CPU allows and compares the
+// result with what was recorded.
+//
+//   snakeReplay file.replay [more.replay ...]
+//
+// Prints one line per file and exits with 1 if any replay failed to load or
+// did not reproduce its recorded outcome.
+#include <iostream>
+#include <chrono>
+#include "replay.h"
+using namespace std;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cerr << "usage: snakeReplay file.replay [more.replay ...]" << endl;
+        return 1;
+    }
+    int bad = 0;
+    long ticks = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 1; i < argc; i++) {
+        Replay r;
+        if (!r.load(argv[i])) {
+            cout << argv[i] << ": not a replay" << endl;
+            bad++;
+            continue;
+        }
+        ReplayResult got = simulate(r);
+        ticks += got.ticks;
+        bool same = !got.stalled && got.ticks == r.ticks && got.score == r.score && got.end == r.end;
+        if (!same) bad++;
+        cout << argv[i] << ": " << r.width << "x" << r.height << " arena " << r.mode << ", " << r.turns.size()
+             << " turns, " << got.ticks << " ticks, score " << got.score << ", end '" << got.end << "' "
+             << (same ? "ok" : got.stalled ? "MISMATCH (stalled)" : "MISMATCH") << endl;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << ticks << " ticks in " << secs << " s (" << (secs > 0 ? ticks / secs : 0) << " ticks/s)" << endl;
+    return bad ? 1 : 0;
+}
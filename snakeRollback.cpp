@@ -0,0 +1,197 @@
+// === Rollback Peer ===
+// One player of a two-player rollback game (rollback.h) over UDP, played by
+// a bot, headless. Start one process per player with the same seed:
+//
+//   snakeRollback -i 0 &
+//   snakeRollback -i 1
+//
+//   snakeRollback -i player [-h host] [-l port] [-r peer port] [-s seed]
+//                 [-n ticks] [-f input delay] [-d ms] [-j ms] [-x percent]
+//                 [-W width] [-H height]
+//
+// Player 0 listens on 7000 and sends to 7001 by default, player 1 the other
+// way round. -f is the input delay in ticks (2), from 0 to
+// RollbackSession::Window - 1. -d, -j and -x put a latency shim in front of
+// the socket that delays every outgoing packet by d ms plus up to j ms of
+// jitter (so they can arrive out of order) and drops x percent of them. Each packet repeats
+// every input the peer has not acknowledged yet, so lost packets only cost
+// time. The game runs at 60 ticks/s for n ticks; the peer then prints its
+// rollback statistics and a checksum of the final state, which must be the
+// same on both sides.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include "rollback.h"
+#include "netSocket.h"
+using namespace std;
+
+// Holds outgoing packets back to simulate a slow, lossy network.
+class LatencyShim {
+    struct Pending {
+        chrono::steady_clock::time_point due;
+        string data;
+    };
+    UdpSocket& socket;
+    chrono::milliseconds delay, jitter;
+    int lossPercent;
+    mt19937 rng;
+    vector<Pending> pending;
+
+public:
+    LatencyShim(UdpSocket& s, int delayMs, int jitterMs, int loss, unsigned seed)
+        : socket(s), delay(delayMs), jitter(jitterMs), lossPercent(loss), rng(seed) {}
+
+    void send(const string& data) {
+        if ((int)(rng() % 100) < lossPercent) return;
+        auto wait = delay + (jitter.count() ? chrono::milliseconds(rng() % (jitter.count() + 1)) : chrono::milliseconds(0));
+        pending.push_back(Pending{chrono::steady_clock::now() + wait, data});
+    }
+
+    // Sends whatever is due.
+    void pump() {
+        auto now = chrono::steady_clock::now();
+        size_t kept = 0;
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (pending[i].due <= now) socket.send(pending[i].data.data(), (int)pending[i].data.size());
+            else if (kept++ != i) pending[kept - 1] = move(pending[i]);
+        }
+        pending.resize(kept);
+    }
+};
+
+// Packet: 'R' first:u32 count:u8 count inputs, ack:u32 (the sender's last
+// confirmed tick of the receiver's inputs, +1 so that -1 fits).
+static void putU32(string& out, long v) {
+    for (int i = 0; i < 4; i++) out += (char)((unsigned long)v >> (8 * i));
+}
+static long getU32(const char* in) {
+    unsigned long v = 0;
+    for (int i = 0; i < 4; i++) v |= (unsigned long)(unsigned char)in[i] << (8 * i);
+    return (long)v;
+}
+
+// Bot: keeps going unless the cell ahead is taken, and now and then turns
+// into a free cell. Uses its own generator: the game's must only be
+// touched by the simulation, or the peers would drift apart.
+static char decide(const Board& board, const MultiSnakeArena& g, int id, mt19937& rng) {
+    const MultiSnakeArena::Player& p = g.player(id);
+    const char dirs[4] = {'w', 'a', 's', 'd'};
+    int ahead = g.cell(board.next(p.headCell(), p.dir));
+    bool blocked = ahead != MultiSnakeArena::Empty && ahead != MultiSnakeArena::FruitCell;
+    if (!blocked && rng() % 8) return 0;
+    int side = rng() & 1 ? 1 : 3;
+    for (int k = 0; k < 2; k++, side ^= 2) {
+        int d = (p.dir + side) & 3;
+        int c = g.cell(board.next(p.headCell(), d));
+        if (c == MultiSnakeArena::Empty || c == MultiSnakeArena::FruitCell) return dirs[d];
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int player = -1, port = -1, peerPort = -1, delay = 0, jitter = 0, loss = 0, inputDelay = 2;
+    int width = 32, height = 32;
+    long ticks = 600;
+    unsigned long seed = 1;
+    string host = "127.0.0.1";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-i")) player = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-h")) host = argv[i + 1];
+        else if (!strcmp(argv[i], "-l")) port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-r")) peerPort = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-s")) seed = strtoul(argv[i + 1], nullptr, 10);
+        else if (!strcmp(argv[i], "-n")) ticks = atol(argv[i + 1]);
+        else if (!strcmp(argv[i], "-f")) inputDelay = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-d")) delay = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-j")) jitter = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-x")) loss = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-W")) width = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-H")) height = atoi(argv[i + 1]);
+        else {
+            cerr << "unknown option " << argv[i] << endl;
+            return 1;
+        }
+    }
+    if (player != 0 && player != 1) {
+        cerr << "usage: snakeRollback -i 0|1 [options]" << endl;
+        return 1;
+    }
+    if (inputDelay < 0 || inputDelay >= RollbackSession::Window) {
+        cerr << "input delay must be between 0 and " << RollbackSession::Window - 1 << " ticks" << endl;
+        return 1;
+    }
+    if (port < 0) port = 7000 + player;
+    if (peerPort < 0) peerPort = 7001 - player;
+    UdpSocket socket = UdpSocket::open(port, host, peerPort);
+    if (!socket.isOpen()) {
+        cerr << "cannot open UDP port " << port << endl;
+        return 1;
+    }
+    LatencyShim shim(socket, delay, jitter, loss, (unsigned)(seed * 2 + player));
+
+    MultiSnakeArena start(Classic(width, height), 4, seed);
+    start.spawn();
+    start.spawn();
+    RollbackSession session(start, player, inputDelay);
+    mt19937 bot((unsigned)(seed * 31 + player));
+    Board board(width, height);
+
+    const auto tick = chrono::microseconds(1000000 / 60);
+    auto next = chrono::steady_clock::now(), doneAt = next;
+    long peerAck = -1, stalls = 0;
+    bool done = false;
+    chrono::duration<double> worst(0), total(0);
+    char buffer[1500];
+    while (!done || chrono::steady_clock::now() - doneAt < chrono::seconds(1)) {
+        this_thread::sleep_until(next);
+        next += tick;
+        auto begin = chrono::steady_clock::now();
+
+        for (int n; (n = socket.receive(buffer, sizeof buffer)) > 0;) {
+            if (n < 10 || buffer[0] != 'R' || n != 10 + (unsigned char)buffer[5]) continue;
+            long first = getU32(buffer + 1);
+            int count = (unsigned char)buffer[5];
+            for (int i = 0; i < count; i++) session.addRemoteInput(first + i, buffer[6 + i]);
+            long ack = getU32(buffer + 6 + count) - 1;
+            if (ack > peerAck) peerAck = ack;
+        }
+
+        if (session.frameCount() < ticks) {
+            if (!session.advance(decide(board, session.state(), player, bot))) stalls++;
+        } else if (!done) {
+            session.resimulate();
+            if (session.settled()) {
+                done = true;
+                doneAt = chrono::steady_clock::now();
+            }
+        }
+
+        // Every input the peer has not confirmed yet, oldest first.
+        long from = peerAck + 1, to = session.localInputsUpTo();
+        if (to - from >= 255) from = to - 254;
+        string packet = "R";
+        putU32(packet, from);
+        packet += (char)(to >= from ? to - from + 1 : 0);
+        for (long t = from; t <= to; t++) packet += session.localInput(t);
+        putU32(packet, session.confirmedRemote() + 1);
+        shim.send(packet);
+        shim.pump();
+
+        chrono::duration<double> spent = chrono::steady_clock::now() - begin;
+        total += spent;
+        if (spent > worst) worst = spent;
+    }
+
+    const MultiSnakeArena& g = session.state();
+    cout << "player " << player << ": " << session.frameCount() << " ticks, " << stalls << " stalled frames" << endl;
+    cout << "rollbacks: " << session.rollbackCount() << "  resimulated ticks: " << session.resimulatedTicks()
+         << "  deepest: " << session.deepestRollback() << "  save/restore: " << session.copyMicros() << " us" << endl;
+    cout << "frame work: avg " << 1e6 * total.count() / session.frameCount() << " us, worst " << 1e6 * worst.count() << " us" << endl;
+    cout << "scores: " << g.player(0).score << " " << g.player(1).score << "  checksum: " << hex << g.checksum() << dec << endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+// === Tick Server ===
+// Runs games authoritatively: every connection gets its own game, which the
+// server steps at a fixed tick rate with the turns the client has sent.
+// After each tick a client is sent only what changed (netProtocol.h), and a
+// finished game is replaced by a new one right away.
+//
+//   snakeServer [-p port] [-r ticks/s] [-a arena] [-W width] [-H height]
+//               [-k keyframe ticks] [-g max games] [-t seconds]
+//
+// arena is 1=Classic, 2=Boundary, 3=Complex. With -k every game also gets
+// a full snapshot that often, which clients use to check their copy. A
+// client that falls more than 64 KB behind is dropped. Every 5 seconds the
+// server prints its games, how long the ticks took and the bytes it sent
+// per game and tick. -t stops it after that many seconds (0 = never).
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include "snakeEngine.h"
+#include "inputQueue.h"
+#include "netProtocol.h"
+#include "netSocket.h"
+using namespace std;
+
+struct Client {
+    TcpSocket socket;
+    unique_ptr<Engine> game;
+    TurnQueue turns;
+    string out;
+    size_t sent = 0;
+};
+
+int main(int argc, char** argv) {
+    int port = 7777, rate = 10, mode = 1, width = 20, height = 20, maxGames = 1000;
+    long keyframe = 0, seconds = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-p")) port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-r")) rate = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-a")) mode = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-W")) width = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-H")) height = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-k")) keyframe = atol(argv[i + 1]);
+        else if (!strcmp(argv[i], "-g")) maxGames = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-t")) seconds = atol(argv[i + 1]);
+        else {
+            cerr << "unknown option " << argv[i] << endl;
+            return 1;
+        }
+    }
+    if (width < 8 || height < 8 || width > Board::maxSide || height > Board::maxSide || rate < 1) {
+        cerr << "board sides must be between 8 and " << Board::maxSide << ", rate at least 1" << endl;
+        return 1;
+    }
+    TcpSocket listener = TcpSocket::listen(port);
+    if (!listener.isOpen()) {
+        cerr << "cannot listen on port " << port << endl;
+        return 1;
+    }
+    cout << "listening on port " << port << ", " << rate << " ticks/s" << endl;
+
+    Arena arena = makeArena(mode, width, height);
+    random_device seeds;
+    vector<unique_ptr<Client>> clients;
+    char buffer[4096];
+    long ticks = 0, gameTicks = 0, bytes = 0, dropped = 0;
+    chrono::duration<double> busy(0);
+    const auto tick = chrono::microseconds(1000000 / rate);
+    auto start = chrono::steady_clock::now(), next = start, report = start;
+
+    while (seconds == 0 || chrono::steady_clock::now() - start < chrono::seconds(seconds)) {
+        this_thread::sleep_until(next);
+        next += tick;
+        auto begin = chrono::steady_clock::now();
+
+        for (TcpSocket s = listener.accept(); s.isOpen(); s = listener.accept()) {
+            if ((int)clients.size() >= maxGames) continue; // closes it
+            unique_ptr<Client> c(new Client);
+            c->socket = move(s);
+            c->game.reset(new Engine(arena, seeds()));
+            NetProtocol::putSnapshot(c->out, *c->game, mode);
+            clients.push_back(move(c));
+        }
+
+        for (auto& c : clients) {
+            // Turns: queued like the SFML front end's, one used per tick.
+            for (int n; (n = c->socket.receive(buffer, sizeof buffer)) > 0;) {
+                for (int i = 0; i < n; i++)
+                    if (Engine::isTurn(buffer[i])) c->turns.push(buffer[i], c->game->snake.checkDir());
+            }
+            Engine& g = *c->game;
+            NetProtocol::Frame before = NetProtocol::capture(g);
+            g.step(c->turns.next(g.snake.checkDir()));
+            NetProtocol::putDelta(c->out, before, g);
+            gameTicks++;
+            if (g.status != 'G') {
+                c->game.reset(new Engine(arena, seeds()));
+                c->turns.clear();
+                NetProtocol::putSnapshot(c->out, *c->game, mode);
+            } else if (keyframe && g.ticks % keyframe == 0) NetProtocol::putSnapshot(c->out, g, mode, true);
+
+            int n = c->socket.send(c->out.data() + c->sent, (int)(c->out.size() - c->sent));
+            if (n < 0) {
+                c->socket.close();
+                continue;
+            }
+            c->sent += n;
+            bytes += n;
+            if (c->out.size() - c->sent > 65536) { // still this far behind after writing what it could
+                c->socket.close();
+                continue;
+            }
+            if (c->sent == c->out.size()) c->out.clear(), c->sent = 0;
+        }
+        size_t kept = 0;
+        for (auto& c : clients) {
+            if (c->socket.isOpen()) clients[kept++] = move(c);
+            else dropped++;
+        }
+        clients.resize(kept);
+        ticks++;
+        busy += chrono::steady_clock::now() - begin;
+
+        if (chrono::steady_clock::now() - report >= chrono::seconds(5)) {
+            report = chrono::steady_clock::now();
+            cout << "games: " << clients.size() << "  dropped: " << dropped << "  tick busy: "
+                 << 1000 * busy.count() / ticks << " ms of " << 1000.0 / rate << " ms  bytes/game/tick: "
+                 << (gameTicks ? (double)bytes / gameTicks : 0) << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+// === Shared-Memory Bot ===
+// Out-of-process player for a game published with sharedState.h, by the
+// SFML game (snake -s name) or by snakeBench -x name, which waits for an
+// answer every tick. It heads for the fruit and avoids walls and its body,
+// answering every state it sees.
+//
+//   snakeShmBot [-s name] [-t seconds]
+//
+// It waits up to the given time for the game to appear and plays until the
+// time is up, then prints how many states it answered per second.
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include "sharedState.h"
+using namespace std;
+
+// The open neighbour of the head closest to the fruit (on the wrap-around
+// board), or 0 to keep going if there is none.
+static char decide(const SharedStateView& v, const Board& board) {
+    const char dirs[4] = {'w', 'a', 's', 'd'};
+    int head = v.body[0], back = dirIndex(v.dir) ^ 2, best = -1, bestDistance = 0;
+    int fx = board.cellX(v.fruit), fy = board.cellY(v.fruit);
+    for (int d = 0; d < 4; d++) {
+        int c = board.next(head, d);
+        int kind = v.cells[c];
+        if (d == back || (kind != SharedStateHeader::Empty && kind != SharedStateHeader::FruitCell)) continue;
+        int dx = abs(board.cellX(c) - fx), dy = abs(board.cellY(c) - fy);
+        int distance = min(dx, v.width - dx) + min(dy, v.height - dy);
+        if (best < 0 || distance < bestDistance) best = d, bestDistance = distance;
+    }
+    return best < 0 ? 0 : dirs[best];
+}
+
+int main(int argc, char** argv) {
+    string name = "snake";
+    long seconds = 10;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-s")) name = argv[i + 1];
+        else if (!strcmp(argv[i], "-t")) seconds = atol(argv[i + 1]);
+        else {
+            cerr << "unknown option " << argv[i] << endl;
+            return 1;
+        }
+    }
+
+    auto start = chrono::steady_clock::now(), end = start + chrono::seconds(seconds);
+    SharedStateReader reader;
+    while (!reader.open(name)) {
+        if (chrono::steady_clock::now() > end) {
+            cerr << "no game published as " << name << endl;
+            return 1;
+        }
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+
+    SharedStateView v;
+    Board board(8, 8);
+    long answered = 0, games = 0, bestScore = 0;
+    int lastGame = -1;
+    for (long spins = 0; (spins & 1023) || chrono::steady_clock::now() < end; spins++) {
+        if (!reader.changed()) {
+            this_thread::yield();
+            continue;
+        }
+        reader.read(v);
+        if (v.width != board.width || v.height != board.height) board = Board(v.width, v.height);
+        if (v.game != lastGame) lastGame = v.game, games++;
+        if (v.score > bestScore) bestScore = v.score;
+        if (v.body.empty()) continue;
+        reader.sendTurn(v, v.status == 'G' ? decide(v, board) : 0);
+        answered++;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "answered: " << answered << " states (" << answered / secs << "/s)  games: " << games
+         << "  best score: " << bestScore << endl;
+    return 0;
+}
@@ -0,0 +1,178 @@
+// === Engine Checks ===
+// Quick checks of the engine rules that are easy to break on small boards.
+// Prints each failure and exits with 1 if there was any.
+//
+//   snakeTest
+#include <iostream>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+#include "snakeEngine.h"
+#include "vecEnv.h"
+#include "hamiltonCycle.h"
+#include "scoreStore.h"
+#include "replay.h"
+using namespace std;
+
+static int failures = 0;
+
+static void check(bool ok, const string& what) {
+    if (ok) return;
+    cerr << "FAIL: " << what << endl;
+    failures++;
+}
+
+// The first fruit must be on a free cell on every arena and size, in the
+// engine and in the vectorized environments.
+static void startFruitIsFree() {
+    for (int mode = 1; mode <= 3; mode++)
+        for (int h = 8; h <= 24; h++)
+            for (int w = 8; w <= 24; w += 4) {
+                string where = "mode " + to_string(mode) + " " + to_string(w) + "x" + to_string(h);
+                Arena arena = makeArena(mode, w, h);
+                Engine e(arena, 1);
+                const Occupancy& o = e.arena.getOccupancy();
+                int fruit = e.board.pack(e.fruit.getPos()[0], e.fruit.getPos()[1]);
+                check(o.isFruit(fruit) && !o.isBody(fruit) && !o.isWall(fruit), "engine start fruit on a taken cell, " + where);
+                check(o.getFreeCount() == w * h - (int)arena.getBlocks().size() - 4, "engine free cells, " + where);
+
+                VecEnv env(1, arena, 1);
+                int c = env.fruitCell(0);
+                bool onSnake = c % w == w / 2 - 1 && c / w >= 3 && c / w <= 5;
+                check(!onSnake && !o.isWall(c), "vecEnv start fruit on a taken cell, " + where);
+            }
+}
+
+// On 8x8 the snake starts at (3, 3..5) heading up; going round the right
+// side of its body it must reach and eat the first fruit.
+static void eatsFirstFruitOn8x8() {
+    Engine e(Classic(8, 8), 1);
+    for (char d : string("dsssa")) check(e.step(d) == 'G', "8x8 step");
+    check(e.score.getScore() == 1, "8x8 first fruit not eaten");
+    check(e.snake.size() == 4, "8x8 length after eating");
+}
+
+// Games split over worker threads must play exactly as on one thread. The
+// boards are small and walled, so most games fill past half and build their
+// free-cell lists while other chunks are stepping.
+static void vecEnvThreadsMatchOnCrowdedBoards() {
+    const int n = 256, side = 8;
+    Arena arena = makeArena(3, side, side);
+    VecEnv one(n, arena, 9), four(n, arena, 9, 4);
+    Board board(side, side);
+    vector<int8_t> actions(n);
+    vector<float> rewards1(n), rewards4(n);
+    vector<uint8_t> dones1(n), dones4(n), obs1(n * side * side), obs4(n * side * side);
+    one.observeAll(obs1.data());
+    long eaten = 0;
+    mt19937 rng(3);
+    for (int t = 0; t < 4000; t++) {
+        // Turn into an open cell if there is one, trying the directions
+        // from a random one on.
+        for (int i = 0; i < n; i++) {
+            const uint8_t* o = &obs1[i * side * side];
+            int first = (int)(rng() & 3);
+            actions[i] = (int8_t)first;
+            for (int k = 0; k < 4; k++) {
+                int d = (first + k) & 3, c = board.next(one.head(i), d);
+                if (o[c] == 0 || o[c] == 4) {
+                    actions[i] = (int8_t)d;
+                    break;
+                }
+            }
+        }
+        one.step(actions.data(), rewards1.data(), dones1.data(), obs1.data());
+        four.step(actions.data(), rewards4.data(), dones4.data(), obs4.data());
+        for (float r : rewards1) eaten += r > 0;
+        if (rewards1 != rewards4 || dones1 != dones4 || obs1 != obs4) {
+            check(false, "vecEnv with 4 threads differs from 1 thread at tick " + to_string(t));
+            return;
+        }
+    }
+    check(eaten > n * 20, "vecEnv crowded boards: too few fruit eaten to fill them");
+}
+
+// The cycle solver taking over again after the autopilot moved the snake
+// must notice the body is off the cycle instead of trusting it still is.
+// Some games are lost while it gets back onto the cycle; trusting the old
+// order lost over 30%.
+static void cycleSolverResumesAfterOtherMoves() {
+    int died = 0;
+    for (unsigned seed = 1; seed <= 200; seed++) {
+        Engine e(Classic(20, 20), seed);
+        CycleSolver solver;
+        Autopilot pilot;
+        char result = 'G';
+        for (int t = 0; t < 300 && result == 'G'; t++) result = e.step(solver.decide(e));
+        for (int t = 0; t < 60 && result == 'G'; t++) result = e.step(pilot.decide(e));
+        for (int t = 0; t < 20000 && result == 'G'; t++) result = e.step(solver.decide(e));
+        if (result == 'b' || result == 's') died++;
+    }
+    check(died <= 20, "cycle solver after autopilot moves: " + to_string(died) + " of 200 games lost");
+}
+
+// Adding scores compacts the log by itself, and a store opened on the
+// compacted files sees the same top scores.
+static void scoreLogStaysBounded() {
+    string name = (filesystem::temp_directory_path() / "snakeTestScores").string();
+    filesystem::remove(name + ".log");
+    filesystem::remove(name + ".idx");
+    const int keep = 20, games = 3000;
+    vector<int> all;
+    {
+        ScoreStore store(name);
+        store.setKeepRecent(keep);
+        mt19937 rng(5);
+        for (int g = 0; g < games; g += 7) {
+            vector<int> batch;
+            for (int k = 0; k < 7; k++) batch.push_back((int)(rng() % 50)); // many ties
+            all.insert(all.end(), batch.begin(), batch.end());
+            check(store.addAll(batch), "score store add");
+        }
+        check(store.size() <= 2 * keep + ScoreStore::TopK, "score log not compacted: " + to_string(store.size()) + " records");
+    }
+    sort(all.begin(), all.end(), greater<int>());
+    all.resize(ScoreStore::TopK);
+    ScoreStore reopened(name);
+    check(reopened.size() <= 2 * keep + ScoreStore::TopK, "score log after reopening: " + to_string(reopened.size()) + " records");
+    check(reopened.top(ScoreStore::TopK) == all, "top scores changed by compaction");
+    uintmax_t bytes = filesystem::file_size(name + ".log");
+    check(bytes == 4 + reopened.size() * sizeof(ScoreStore::Record), "score log size does not match its record count");
+    filesystem::remove(name + ".log");
+    filesystem::remove(name + ".idx");
+}
+
+// A replay claiming an endless game of circling without eating is stopped
+// at the stall limit and reported, and a file with an unknown arena mode
+// does not load.
+static void replayChecksAreBounded() {
+    string path = (filesystem::temp_directory_path() / "snakeTest.replay").string();
+    Replay r;
+    r.seed = 4;
+    r.width = r.height = 8;
+    r.ticks = 1L << 40;
+    for (long t = 0; t < 16; t++) r.turns.push_back(TurnEvent{t, "awds"[t & 3]}); // then straight on round the edge forever
+    check(r.save(path), "replay save");
+    Replay loaded;
+    check(loaded.load(path), "replay load");
+    ReplayResult got = simulate(loaded);
+    check(got.stalled && got.ticks < 2 * stallTicks(loaded), "replay without fruit not stopped at the stall limit");
+
+    r.mode = 7;
+    r.save(path);
+    check(!loaded.load(path), "replay with arena mode 7 loaded");
+    filesystem::remove(path);
+}
+
+int main() {
+    startFruitIsFree();
+    eatsFirstFruitOn8x8();
+    vecEnvThreadsMatchOnCrowdedBoards();
+    cycleSolverResumesAfterOtherMoves();
+    scoreLogStaysBounded();
+    replayChecksAreBounded();
+    if (failures) return 1;
+    cout << "all checks passed" << endl;
+    return 0;
+}
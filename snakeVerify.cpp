@@ -0,0 +1,96 @@
+// === Replay Verifier ===
+// Checks a directory of submitted replays: each one is re-simulated with the
+// engine and must reproduce its recorded tick count, score and how the game
+// ended ('b' block, 's' self, 'W' board full). A replay that goes 8 x cells
+// ticks without eating is stopped there and fails, whatever tick count it
+// claims. Files are spread over a work-stealing pool with one worker per
+// core.
+//
+//   snakeVerify [-j threads] [-q] dir
+//
+// -q only prints the files that failed. Exits with 1 if any file failed.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include "replay.h"
+#include "workPool.h"
+using namespace std;
+
+struct Verdict {
+    bool loaded = false;
+    bool ok = false;
+    Replay claimed;
+    ReplayResult got{0, 0, 'G', false};
+};
+
+int main(int argc, char** argv) {
+    unsigned threads = thread::hardware_concurrency();
+    bool quiet = false;
+    string dir;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-q")) quiet = true;
+        else dir = argv[i];
+    }
+    if (dir.empty()) {
+        cerr << "usage: snakeVerify [-j threads] [-q] dir" << endl;
+        return 1;
+    }
+
+    vector<string> files;
+    error_code ec;
+    for (const auto& entry : filesystem::directory_iterator(dir, ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".replay") files.push_back(entry.path().string());
+    if (ec) {
+        cerr << "cannot read " << dir << ": " << ec.message() << endl;
+        return 1;
+    }
+
+    vector<Verdict> verdicts(files.size());
+    atomic<long> ticks{0};
+    auto start = chrono::steady_clock::now();
+    {
+        WorkPool pool(threads);
+        threads = pool.size();
+        for (size_t i = 0; i < files.size(); i++) {
+            pool.submit([&, i] {
+                Verdict& v = verdicts[i];
+                v.loaded = v.claimed.load(files[i]);
+                if (!v.loaded) return;
+                v.got = simulate(v.claimed);
+                v.ok = !v.got.stalled && v.got.ticks == v.claimed.ticks && v.got.score == v.claimed.score && v.got.end == v.claimed.end;
+                ticks += v.got.ticks;
+                v.claimed.turns.clear();
+                v.claimed.turns.shrink_to_fit();
+            });
+        }
+        pool.wait();
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long good = 0, unreadable = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        const Verdict& v = verdicts[i];
+        if (!v.loaded) {
+            unreadable++;
+            cout << files[i] << ": not a replay" << endl;
+        } else if (!v.ok) {
+            cout << files[i] << ": claimed score " << v.claimed.score << " end '" << v.claimed.end << "' after "
+                 << v.claimed.ticks << " ticks, replay gives score " << v.got.score << " end '" << v.got.end
+                 << "' after " << v.got.ticks << (v.got.stalled ? " (stalled, no fruit)" : "") << endl;
+        } else {
+            good++;
+            if (!quiet) cout << files[i] << ": ok, score " << v.claimed.score << endl;
+        }
+    }
+    long bad = (long)files.size() - good - unreadable;
+    cout << files.size() << " replays: " << good << " ok, " << bad << " mismatched, " << unreadable << " unreadable" << endl;
+    cout << threads << " threads, " << secs << " s, " << (secs > 0 ? files.size() / secs : 0) << " replays/s, "
+         << (secs > 0 ? ticks / secs : 0) << " ticks/s" << endl;
+    return good == (long)files.size() ? 0 : 1;
+}
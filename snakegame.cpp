@@ -1,6 +1,8 @@
 #include <iostream>
 #include <vector>
-#include <random>
+#include <string>
+#include "snakeEngine.h"
+#include "terminalRenderer.h"
 #include <chrono>  // for functions like steady_clock and duration_cast (time oriented functions)
 #include <cstdlib> // for rand() and srand()
 #include <ctime>   // for time()
@@ -56,26 +58,6 @@ public:
     }
 };
 
-// Fruit class handles fruit spawning and repositioning
-class Fruit
-{
-    vector<int> position; // Stores fruit's current position (x, y)
-public:
-    char fruit; // Added to store the character/symbol used to display the fruit
-
-    // Constructor allows setting a custom fruit character, with default as 'F'
-    Fruit(char fruitChar = 'F', int x = 9, int y = 9) : position({x, y}), fruit(fruitChar) {}
-
-    // Getter function to return fruit position
-    vector<int> getPos() const { return position; }
-
-    // Change fruit position ensuring it doesn't overlap with the snake
-    void changeFruitPos(const vector<vector<int>> &snake)
-    {
-        // cheak whether the snake not there before placing the fruit there.
-    }
-};
-
 class SpecialFruitType
 {
     vector<char> specialFruits; // List of special fruit symbols
@@ -118,31 +100,18 @@ public:
         srand(time(0)); // Seeds the random number generator using the current time
     }
 
-    // place fruit randomly, avoiding overlap with the snake
-    void spawn(const vector<vector<int>> &snake)
+    // place fruit on a random free cell, so it never overlaps the snake, a block or the fruit
+    void spawn(const Occupancy &o)
     {
-        int x, y;
-        bool overlap; // flag to check if the position is already occupied by the snake.
-
-        do
+        if (o.getFreeCount() == 0)
         {
-            x = rand() % 20; // Random x from 0 to 19
-            y = rand() % 20; // Random y from 0 to 19
-            overlap = false; //  reset to false for each new random position.
+            return; // board is full, nowhere to put it
+        }
 
-            // Check if this position overlaps with any part of the snake
-            for (const auto &segment : snake)
-            {
-                if (segment[0] == x && segment[1] == y)
-                {
-                    overlap = true; // shows that it is overlapping if the position is matched
-                    break;
-                }
-            }
-        } while (overlap); // Keep generating positions until a safe one is found
+        int cell = o.getFreeCell(rand() % o.getFreeCount()); // one random pick, no retries
 
-        position = {x, y}; // Set the new position for the fruit
-        active = true;     // Mark the fruit as active and then display on the game
+        position = {cell % o.getWidth(), cell / o.getWidth()}; // Set the new position for the fruit
+        active = true;                     // Mark the fruit as active and then display on the game
     }
 
     // remove the fruit from the board
@@ -176,240 +145,88 @@ public:
     }
 };
 
-// Score class to track and manage player's score
-class Score
+// Arena used by the console game: a column of blocks down the left edge
+class LeftWall : public Arena
 {
-    int score;
-
 public:
-    Score() : score(0) {}
-
-    void increaseScore() { score++; } // Increment score
-
-    int getScore() const { return score; } // Return current score
-};
-
-// Block class represents obstacles in the game
-class Block
-{
-    vector<int> position;
-    char block;
-
-public:
-    Block(int x, int y) : position({x, y}), block('B') {}
-
-    char getBlockType() { return block; }
-
-    // Check if the snake collides with the block
-    bool checkIfHit(vector<int> pos) const
+    LeftWall(int w = 20, int h = 20) : Arena(w, h)
     {
-        return position == pos;
-    }
-
-    vector<int> getPosition() const
-    {
-        return position;
-    }
-};
-
-// Snake class handles movement, collision detection, and growth
-class Snake
-{
-public:
-    vector<vector<int>> snake;
-    char dir;
-
-    Snake()
-    {
-        // Initial snake size with three segments
-        for (int i = 0; i < 3; i++)
+        for (int i = 0; i < h; i++)
         {
-            snake.push_back({9, 3 + i});
+            addBlock(0, i); // Add boundary blocks
         }
-        dir = 'w'; // Default direction (up)
-    }
-
-    char checkDir() { return dir; }              // Get current direction
-    vector<int> checkHead() { return snake[0]; } // Get snake's head position
-
-    // Increase the snake's size by duplicating its last segment
-    void increaseSnakeSize()
-    {
-        snake.push_back(snake.back());
-    }
-
-    // Move the snake based on user input, check for collisions, and update position
-    char move(char position, Fruit &f, Score &s, const vector<Block> &b)
-    {
-        int prevX = snake[0][0], prevY = snake[0][1];
-
-        // Update snake's head position based on direction
-        switch (position)
-        {
-        case 'w':
-            snake[0][1]--;
-            break;
-        case 's':
-            snake[0][1]++;
-            break;
-        case 'd':
-            snake[0][0]++;
-            break;
-        case 'a':
-            snake[0][0]--;
-            break;
-        }
-
-        if (snake[0][1] >= 20) // If snake moves out from the bottom, come out from top
-            snake[0][1] = 0;
-        else if (snake[0][1] < 0) // If snake moves out from the top, come out from bottom
-            snake[0][1] = 19;
-
-        if (snake[0][0] >= 20) // If snake moves out from the right, come out from left
-            snake[0][0] = 0;
-        else if (snake[0][0] < 0) // If snake moves out from the left, come out from right
-            snake[0][0] = 19;
-
-        // Check collision with blocks
-        for (const auto &block : b)
-        {
-            if (block.checkIfHit(snake[0]))
-            {
-                return 'b';
-            }
-        }
-
-        // Check collision with itself
-        for (size_t i = 1; i < snake.size(); i++)
-        {
-            if (snake[0] == snake[i])
-            {
-                return 's';
-            }
-        }
-
-        dir = position; // Update direction
-
-        // Check if the snake eats the fruit
-        vector<int> fruitPos = f.getPos();
-        if (fruitPos[0] == snake[0][0] && fruitPos[1] == snake[0][1])
-        {
-            increaseSnakeSize();     // Grow snake
-            f.changeFruitPos(snake); // Respawn fruit
-            s.increaseScore();       // Increase score
-        }
-
-        // Move the snake's body
-        for (size_t i = 1; i < snake.size(); i++)
-        {
-            swap(prevX, snake[i][0]);
-            swap(prevY, snake[i][1]);
-        }
-
-        return 'G'; // Game continues
     }
 };
 
-// Arena class handles the game board and obstacles
-class Arena
+// ConsoleView draws the game state as a grid of characters; the terminal
+// renderer only rewrites the cells that changed since the last frame
+class ConsoleView
 {
-    char arena[20][20];
-    vector<Block> blocks;
+    TerminalRenderer screen;
+    char fruitChar; // Symbol the player picked for the fruit
 
 public:
-    Arena()
-    {
-        resetArena();
-        for (int i = 0; i < 20; i++)
-        {
-            blocks.push_back(Block(0, i)); // Add boundary blocks
-            arena[0][i] = 'B';
-        }
-    }
-
-    void resetArena()
-    {
-        for (int i = 0; i < 20; i++)
-            for (int j = 0; j < 20; j++)
-                arena[i][j] = '.';
-    }
-
-    const vector<Block> &getBlocks() const { return blocks; } // Return block list
+    ConsoleView(char fruitSymbol = 'F') : fruitChar(fruitSymbol) {}
 
     // Print the arena with snake, fruit, and obstacles
-    void printArena(const Snake &s, const Fruit &f, Score &sc, const SpecialFruit &spf)
+    void printArena(const Engine &e, const SpecialFruit &spf)
     {
-        cout << endl;
-        resetArena();
+        screen.begin(e.width(), e.height());
 
         // Place the fruit
-        vector<int> fruitPos = f.getPos();
-        arena[fruitPos[1]][fruitPos[0]] = 'F'; // Correct row/col indexing
+        vector<int> fruitPos = e.fruit.getPos();
+        screen.put(fruitPos[0], fruitPos[1], fruitChar);
 
         // Place the special fruit if it is active
         if (spf.isActive())
         {
             vector<int> spfPos = spf.getPosition();
-            arena[spfPos[1]][spfPos[0]] = spf.getChar(); // Use actual special fruit symbol
+            screen.put(spfPos[0], spfPos[1], spf.getChar()); // Use actual special fruit symbol
         }
 
         // Place the snake
-        for (size_t i = 0; i < s.snake.size(); i++)
+        for (int i = 0; i < e.snake.size(); i++)
         {
-            int x = s.snake[i][0], y = s.snake[i][1];
-            arena[y][x] = (i == 0) ? '@' : '#'; // '@' for head, '#' for body
+            screen.put(e.snake.segmentX(i), e.snake.segmentY(i), (i == 0) ? '@' : '#'); // '@' for head, '#' for body
         }
 
         // Place blocks
-        for (auto &block : blocks)
+        for (auto &block : e.arena.getBlocks())
         {
             vector<int> pos = block.getPosition();
-            int x = pos[0], y = pos[1];
-            if (x >= 0 && x < 20 && y >= 0 && y < 20)
-            {
-                arena[y][x] = 'B';
-            }
-        }
-
-        // Print the arena
-        for (int i = 0; i < 20; i++)
-        {
-            for (int j = 0; j < 20; j++)
-                cout << arena[i][j] << " ";
-            cout << endl;
+            screen.put(pos[0], pos[1], 'B');
         }
 
-        cout << "Score: " << sc.getScore();
+        screen.setStatus("Score: " + to_string(e.score.getScore()));
+        screen.present();
     }
 };
 
-// Game class to manage game logic and interaction
+// Game class connects the console input and output to the engine
 class Game
 {
-    Arena arena;
-    Snake snake;
-    Fruit fruit;
-    Score score;
+    Engine engine;
+    ConsoleView view;
 
 public:
-    // Parameterized constructor to accept pre-initialized components
-    Game(Fruit f, Score s, Snake sn, Arena a) : fruit(f), score(s), snake(sn), arena(a) {}
+    // The fruit symbol only changes how the fruit is printed
+    Game(char fruitSymbol) : engine(LeftWall(), random_device{}()), view(fruitSymbol) {}
 
     // Process user input and move the snake
     char move(char dir)
     {
-        if ((snake.checkDir() == 'w' && dir == 's') ||
-            (snake.checkDir() == 's' && dir == 'w') ||
-            (snake.checkDir() == 'a' && dir == 'd') ||
-            (snake.checkDir() == 'd' && dir == 'a'))
+        if (Engine::isReverse(engine.snake.checkDir(), dir))
         {
             return 'G';
         }
-        return snake.move(dir, fruit, score, arena.getBlocks());
+        return engine.step(dir);
     }
 
+    Snake &getSnake() { return engine.snake; }
+    Occupancy &getOccupancy() { return engine.arena.getOccupancy(); }
+
     void printGame(const SpecialFruit &spf) {
-        arena.printArena(snake, fruit, score, spf);
+        view.printArena(engine, spf);
     }
 };
 
@@ -449,22 +266,16 @@ int main()
     FruitType fruitType;     // New addition
     fruitType.chooseFruit(); // Prompt user for choice
 
-    // Initialize game objects using the selected fruit symbol
-    Fruit fruit(fruitType.getSelectedFruit()); // Pass selected symbol to Fruit
-    Score score;
-    Snake snake;
-    Arena arena;
-
     // Special fruit setup
     SpecialFruitType specialFruitType;           // Handles random selection
     SpecialFruit specialFruit;                   // The fruit (position + symbol)
     auto lastSpecialSpawn = steady_clock::now(); // Timer for 15s spawn (NEED TO UNDERSTAND FURTHER GPT)
 
-    Game game(fruit, score, snake, arena);
+    Game game(fruitType.getSelectedFruit()); // Pass selected symbol to the game
+    Snake &snake = game.getSnake();
     Voice voice;
 
     game.printGame(specialFruit); // include special fruit
-    cout << endl;
 
     char move;
 
@@ -496,10 +307,16 @@ int main()
                 cout << "Game Over. You hit yourself." << endl;
                 break;
             }
+            else if (result == 'W')
+            {
+                voice.playGameOverSound(); // Board is full
+                cout << "You win! The board is full." << endl;
+                break;
+            }
 
             // See if the snake grew
-            static int prevLength = snake.snake.size(); // keeps old length
-            if (snake.snake.size() > prevLength)
+            static int prevLength = snake.size(); // keeps old length
+            if (snake.size() > prevLength)
             {
                 // Check if it ate special fruit
                 if (specialFruit.isActive() && snake.checkHead() == specialFruit.getPosition())
@@ -511,7 +328,7 @@ int main()
                 {
                     voice.playFruitSound();
                 }
-                prevLength = snake.snake.size(); // update the stored length
+                prevLength = snake.size(); // update the stored length
             }
         }
 
@@ -541,8 +358,8 @@ int main()
             specialFruit.setChar(specialFruitType.getSpecialFruit());
 
             // Place the special fruit somewhere on the board,
-            // ensuring it doesn't overlap with the snake's body
-            specialFruit.spawn(snake.snake);
+            // ensuring it doesn't overlap with the snake's body or a block
+            specialFruit.spawn(game.getOccupancy());
 
             // Update the last spawn time to the current time
             // This ensures we wait another 15 seconds before spawning the next one
@@ -551,7 +368,6 @@ int main()
 
         // Step 9: Display the entire game board, including the snake, fruit, and special fruit
         game.printGame(specialFruit);
-        cout << endl;
     }
 
     return 0;
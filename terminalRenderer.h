@@ -0,0 +1,122 @@
+// === Terminal Renderer ===
+// Draws a character grid in the terminal for the console front ends. It keeps
+// the frame that is currently on screen and, for each new frame, only emits
+// the cells that changed (using ANSI cursor moves), plus the status line.
+// The whole frame goes out in a single write so nothing is flushed per line.
+//
+// Each cell is printed as "c " like the old printArena. The grid starts at
+// the top-left corner, the status line is right below it and the cursor is
+// left on the line after that, with the rest of the screen cleared, so
+// prompts and messages printed with cout appear under the board.
+// print() is for frames that should stay on screen: it writes the frame as
+// plain lines at the cursor instead.
+#ifndef TERMINAL_RENDERER_H
+#define TERMINAL_RENDERER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+class TerminalRenderer {
+    int width = 0, height = 0;
+    std::vector<char> shown; // cells currently on screen
+    std::vector<char> frame; // cells of the frame being built
+    std::string shownStatus, status;
+    std::string out;
+    bool full = true; // next present() redraws everything
+
+    void moveTo(int row, int col) {
+        out += "\x1b[";
+        out += std::to_string(row);
+        out += ';';
+        out += std::to_string(col);
+        out += 'H';
+    }
+
+    void writeOut() {
+        std::cout.flush(); // anything printed with cout goes first
+        std::fflush(stdout);
+#ifdef _WIN32
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        std::fflush(stdout);
+#else
+        size_t done = 0;
+        while (done < out.size()) {
+            ssize_t n = ::write(STDOUT_FILENO, out.data() + done, out.size() - done);
+            if (n <= 0) break;
+            done += n;
+        }
+#endif
+    }
+
+public:
+    // Start a new frame of w x h cells, all set to the background character.
+    void begin(int w, int h, char background = '.') {
+        if (w != width || h != height) {
+            width = w;
+            height = h;
+            shown.assign(w * h, 0);
+            full = true;
+        }
+        frame.assign(w * h, background);
+    }
+
+    void put(int x, int y, char c) {
+        if (x >= 0 && x < width && y >= 0 && y < height) frame[y * width + x] = c;
+    }
+
+    void setStatus(const std::string& s) { status = s; }
+
+    // Forget what is on screen, e.g. after something else scrolled it away.
+    void invalidate() { full = true; }
+
+    // Writes the whole frame and the status line at the cursor, without
+    // moving it or clearing anything, and leaves the cursor on the next line.
+    void print() {
+        out.clear();
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                out += frame[y * width + x];
+                out += ' ';
+            }
+            out += '\n';
+        }
+        out += status;
+        out += '\n';
+        full = true; // the next present() cannot reuse what is on screen
+        writeOut();
+    }
+
+    void present() {
+        out.clear();
+        if (full) out += "\x1b[H\x1b[2J";
+        for (int y = 0; y < height; y++) {
+            int cursorX = -1;
+            for (int x = 0; x < width; x++) {
+                int i = y * width + x;
+                if (!full && frame[i] == shown[i]) continue;
+                if (cursorX != x) moveTo(y + 1, 2 * x + 1);
+                out += frame[i];
+                out += ' ';
+                cursorX = x + 1;
+                shown[i] = frame[i];
+            }
+        }
+        if (full || status != shownStatus) {
+            moveTo(height + 1, 1);
+            out += status;
+            out += "\x1b[K";
+            shownStatus = status;
+        }
+        moveTo(height + 2, 1);
+        out += "\x1b[J";
+        full = false;
+        writeOut();
+    }
+};
+
+#endif
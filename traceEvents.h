@@ -0,0 +1,162 @@
+// === Trace Events ===
+// Scoped spans for looking at single frames rather than averages. Put
+// TRACE_SPAN("name") at the top of a block and the time until the block
+// ends is recorded; traceWrite(path) saves everything recorded so far as
+// Chrome trace-event JSON, which chrome://tracing and ui.perfetto.dev open.
+//
+// Tracing is compiled in only with -DSNAKE_TRACE. Without it the macros
+// expand to nothing and traceWrite() returns false, so the engine and the
+// front ends are the same code with or without it.
+//
+// Each thread records into its own buffer, a chain of fixed-size blocks
+// that only that thread appends to: an event is written first and then
+// published by a release store of the block's count, so recording takes no
+// lock and traceWrite() can read every thread's events while they run.
+// Buffers are never freed (a thread's events outlive it) and stop taking
+// events at MaxEvents per thread; the rest are counted as dropped. Names
+// must be string literals, only the pointer is kept.
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+
+#include <string>
+
+#ifdef SNAKE_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+class TraceLog {
+public:
+    static constexpr int BlockEvents = 4096;
+    static constexpr long MaxEvents = 1L << 20; // per thread, about 24 MB
+
+private:
+    struct Event {
+        const char* name;
+        std::uint64_t start, duration; // ns since the log was created
+    };
+    struct Block {
+        Event events[BlockEvents];
+        std::atomic<int> count{0};
+        std::atomic<Block*> next{nullptr};
+    };
+    struct Thread {
+        Block* first;
+        Block* last;
+        long events = 0;
+        std::atomic<long> dropped{0};
+        std::atomic<const char*> name{nullptr};
+        int id;
+        Thread* next;
+    };
+
+    std::atomic<Thread*> threads{nullptr};
+    std::atomic<int> nextId{1};
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    TraceLog() {}
+
+    Thread& local() {
+        thread_local Thread* t = nullptr;
+        if (!t) {
+            t = new Thread;
+            t->first = t->last = new Block;
+            t->id = nextId++;
+            t->next = threads.load();
+            while (!threads.compare_exchange_weak(t->next, t)) {}
+        }
+        return *t;
+    }
+
+public:
+    static TraceLog& instance() {
+        static TraceLog log;
+        return log;
+    }
+
+    std::uint64_t now() const {
+        return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void nameThread(const char* name) { local().name.store(name, std::memory_order_release); }
+
+    void record(const char* name, std::uint64_t start, std::uint64_t end) {
+        Thread& t = local();
+        if (t.events == MaxEvents) {
+            t.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Block* b = t.last;
+        int n = b->count.load(std::memory_order_relaxed);
+        if (n == BlockEvents) {
+            Block* fresh = new Block;
+            b->next.store(fresh, std::memory_order_release);
+            t.last = b = fresh;
+            n = 0;
+        }
+        b->events[n] = Event{name, start, end - start};
+        b->count.store(n + 1, std::memory_order_release);
+        t.events++;
+    }
+
+    // Complete ("X") events with microsecond timestamps, one thread_name
+    // record per thread, and the dropped counts under "otherData".
+    bool write(const std::string& path) const {
+        FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) return false;
+        std::fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+        long dropped = 0;
+        bool first = true;
+        for (Thread* t = threads.load(std::memory_order_acquire); t; t = t->next) {
+            dropped += t->dropped.load(std::memory_order_relaxed);
+            const char* name = t->name.load(std::memory_order_acquire);
+            if (name) {
+                std::fprintf(out, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                             first ? "" : ",\n", t->id, name);
+                first = false;
+            }
+            for (Block* b = t->first; b; b = b->next.load(std::memory_order_acquire)) {
+                int n = b->count.load(std::memory_order_acquire);
+                for (int i = 0; i < n; i++) {
+                    const Event& e = b->events[i];
+                    std::fprintf(out, "%s{\"ph\": \"X\", \"name\": \"%s\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                                 first ? "" : ",\n", e.name, t->id, e.start / 1000.0, e.duration / 1000.0);
+                    first = false;
+                }
+            }
+        }
+        std::fprintf(out, "\n], \"otherData\": {\"dropped\": %ld}}\n", dropped);
+        return std::fclose(out) == 0;
+    }
+};
+
+class TraceSpan {
+    const char* name;
+    std::uint64_t start;
+
+public:
+    explicit TraceSpan(const char* n) : name(n), start(TraceLog::instance().now()) {}
+    ~TraceSpan() { TraceLog::instance().record(name, start, TraceLog::instance().now()); }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_THREAD(name) TraceLog::instance().nameThread(name)
+
+inline bool traceWrite(const std::string& path) { return TraceLog::instance().write(path); }
+
+#else
+
+#define TRACE_SPAN(name) do {} while (0)
+#define TRACE_THREAD(name) do {} while (0)
+
+inline bool traceWrite(const std::string&) { return false; }
+
+#endif
+
+#endif
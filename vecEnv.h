@@ -0,0 +1,269 @@
+// === Vectorized Environments ===
+// N independent games on the same arena, stored as structure of arrays and
+// advanced together by one step(actions) call, for training agents.
+//
+// Per game there is one slot in each array: head and tail index into that
+// game's slice of the body ring, direction, growth, fruit cell, score, tick
+// count and a small random generator. Bodies live in one contiguous array
+// (a power-of-two ring per game) and body occupancy in one bitset per game.
+// While at most half of a board is taken, a fruit is placed by drawing
+// random cells (under two draws on average). Past that, the game builds a
+// list of its free cells like Occupancy's, a swap-remove array with a
+// position index (its slice of two shared arrays), keeps it up to date on
+// every step and picks from it in constant time, until the episode ends.
+// Building it costs the board size once, after the snake has eaten about
+// half the board; keeping it on every step from the start would cost a
+// cache miss per step on large boards.
+// The rules are the engine's (walls, body with the old tail still counting,
+// wrap-around, growing by one per fruit, 'W' when the board fills up);
+// only fruit placement uses the per-game generator instead of Fruit's, so
+// a game here does not match an Engine game with the same seed.
+//
+// step() writes, for every game, the reward (+1 fruit or full board, -1
+// death, else 0), a done flag and, if asked for, an observation of the
+// board (cells bytes: 0 empty, 1 wall, 2 body, 3 head, 4 fruit). Finished
+// games are reset right away, so the observation of a done game is the
+// first frame of its next episode; finalScore() keeps the score it ended
+// with. With threads > 1 the games are split into one chunk per worker.
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "snakeEngine.h"
+#include "workPool.h"
+
+template <class B>
+class BasicVecEnv {
+    B board;
+    int n, width, height, cells, cap, mask, words;
+    std::vector<std::uint64_t> walls; // shared by all games
+    std::vector<std::uint8_t> wallObs;
+    int wallCount = 0;
+
+    // Structure of arrays, one entry per game.
+    std::vector<int> heads, tails, growth, fruit, scores, finals, freeCounts;
+    std::vector<long> ticks;
+    std::vector<std::uint8_t> dirs; // dirIndex
+    std::vector<std::uint8_t> listed; // free-cell list built this episode
+    std::vector<std::uint64_t> rng;
+    std::vector<int> bodies;           // n * cap
+    std::vector<std::uint64_t> occ;    // n * words
+    // Allocated up front but not initialized, so the pages of a game's
+    // slice are only touched once that game builds its list.
+    std::unique_ptr<int[]> frees;      // n * cells, free cells first
+    std::unique_ptr<int[]> freeSlots;  // n * cells, index in frees, -1 when taken
+    long limit = 0;
+    std::unique_ptr<WorkPool> pool;
+
+    static std::uint64_t next(std::uint64_t& s) { // splitmix64
+        std::uint64_t z = (s += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    static bool test(const std::uint64_t* bits, int c) { return (bits[c >> 6] >> (c & 63)) & 1; }
+
+    int length(int i) const { return ((heads[i] - tails[i]) & mask) + 1; }
+
+    // Free-cell list of game i: take() removes a cell (swapping the last
+    // free one into its slot), release() puts one back at the end.
+    void take(int i, int c) {
+        int* free = &frees[(size_t)i * cells];
+        int* slot = &freeSlots[(size_t)i * cells];
+        int k = slot[c];
+        if (k < 0) return;
+        int last = free[--freeCounts[i]];
+        free[k] = last;
+        slot[last] = k;
+        slot[c] = -1;
+    }
+    void release(int i, int c) {
+        int* slot = &freeSlots[(size_t)i * cells];
+        if (slot[c] >= 0) return;
+        slot[c] = freeCounts[i];
+        frees[(size_t)i * cells + freeCounts[i]++] = c;
+    }
+    // Called with the fruit eaten, so every cell not wall or body is free.
+    void buildFreeList(int i) {
+        const std::uint64_t* body = &occ[(size_t)i * words];
+        int* slot = &freeSlots[(size_t)i * cells];
+        freeCounts[i] = 0;
+        for (int c = 0; c < cells; c++) {
+            slot[c] = -1;
+            if (!test(walls.data(), c) && !test(body, c)) release(i, c);
+        }
+        listed[i] = 1;
+    }
+
+    // Puts the fruit on a random free cell; false when there is none.
+    bool placeFruit(int i) {
+        if (!listed[i]) {
+            if (2 * (wallCount + length(i)) <= cells) {
+                const std::uint64_t* body = &occ[(size_t)i * words];
+                for (int tries = 0; tries < 64; tries++) {
+                    int c = (int)((next(rng[i]) >> 32) * (std::uint64_t)cells >> 32);
+                    if (!test(walls.data(), c) && !test(body, c)) return fruit[i] = c, true;
+                }
+            }
+            buildFreeList(i);
+        }
+        if (freeCounts[i] == 0) return false;
+        int k = (int)((next(rng[i]) >> 32) * (std::uint64_t)freeCounts[i] >> 32);
+        fruit[i] = frees[(size_t)i * cells + k];
+        take(i, fruit[i]);
+        return true;
+    }
+
+    // Same start as the engine: three cells at (w/2-1, 3..5) heading up,
+    // fruit at (w/2-1, startFruitY(h)).
+    void reset(int i) {
+        std::uint64_t* body = &occ[(size_t)i * words];
+        std::memset(body, 0, words * sizeof(std::uint64_t));
+        listed[i] = 0;
+        int* ring = &bodies[(size_t)i * cap];
+        for (int k = 0; k < 3; k++) {
+            ring[2 - k] = board.pack(width / 2 - 1, 3 + k);
+            body[ring[2 - k] >> 6] |= std::uint64_t(1) << (ring[2 - k] & 63);
+        }
+        heads[i] = 2;
+        tails[i] = 0;
+        growth[i] = 0;
+        dirs[i] = 0;
+        scores[i] = 0;
+        ticks[i] = 0;
+        fruit[i] = board.pack(width / 2 - 1, startFruitY(height));
+    }
+
+    // Returns the reward and sets done.
+    float stepOne(int i, int action, std::uint8_t& done) {
+        done = 0;
+        int d = dirs[i];
+        if (action >= 0 && action < 4 && action != (d ^ 2)) d = action; // w a s d: reverse is d ^ 2
+        int* ring = &bodies[(size_t)i * cap];
+        std::uint64_t* body = &occ[(size_t)i * words];
+        int cell = board.next(ring[heads[i]], d);
+        ticks[i]++;
+        if (test(walls.data(), cell) || test(body, cell)) {
+            done = 1;
+            return -1;
+        }
+        dirs[i] = (std::uint8_t)d;
+        bool ate = cell == fruit[i];
+        if (ate) growth[i]++;
+        heads[i] = (heads[i] + 1) & mask;
+        ring[heads[i]] = cell;
+        body[cell >> 6] |= std::uint64_t(1) << (cell & 63);
+        if (listed[i]) take(i, cell);
+        if (growth[i] > 0) growth[i]--;
+        else {
+            int t = ring[tails[i]];
+            body[t >> 6] &= ~(std::uint64_t(1) << (t & 63));
+            if (listed[i]) release(i, t);
+            tails[i] = (tails[i] + 1) & mask;
+        }
+        if (ate) {
+            scores[i]++;
+            if (!placeFruit(i)) done = 1; // board full
+            return 1;
+        }
+        if (limit && ticks[i] >= limit) done = 1;
+        return 0;
+    }
+
+    void observe(int i, std::uint8_t* out) const {
+        std::memcpy(out, wallObs.data(), cells);
+        const int* ring = &bodies[(size_t)i * cap];
+        for (int k = tails[i]; k != heads[i]; k = (k + 1) & mask) out[ring[k]] = 2;
+        out[ring[heads[i]]] = 3;
+        out[fruit[i]] = 4;
+    }
+
+    void stepRange(int from, int to, const std::int8_t* actions, float* rewards, std::uint8_t* dones, std::uint8_t* obs) {
+        for (int i = from; i < to; i++) {
+            rewards[i] = stepOne(i, actions[i], dones[i]);
+            if (dones[i]) {
+                finals[i] = scores[i];
+                reset(i);
+            }
+            if (obs) observe(i, obs + (size_t)i * cells);
+        }
+    }
+
+public:
+    BasicVecEnv(int count, const Arena& arena, std::uint64_t seed, unsigned threads = 1)
+        : board(arena.getWidth(), arena.getHeight()), n(count), width(arena.getWidth()), height(arena.getHeight()) {
+        cells = width * height;
+        cap = 1;
+        while (cap < cells) cap <<= 1;
+        mask = cap - 1;
+        words = (cells + 63) / 64;
+        walls.assign(words, 0);
+        wallObs.assign(cells, 0);
+        const Occupancy& o = arena.getOccupancy();
+        for (int c = 0; c < cells; c++)
+            if (o.isWall(c)) {
+                walls[c >> 6] |= std::uint64_t(1) << (c & 63);
+                wallObs[c] = 1;
+                wallCount++;
+            }
+        heads.resize(n);
+        tails.resize(n);
+        growth.resize(n);
+        fruit.resize(n);
+        scores.resize(n);
+        finals.assign(n, 0);
+        ticks.resize(n);
+        dirs.resize(n);
+        rng.resize(n);
+        bodies.resize((size_t)n * cap);
+        occ.resize((size_t)n * words);
+        freeCounts.assign(n, 0);
+        listed.assign(n, 0);
+        frees.reset(new int[(size_t)n * cells]);
+        freeSlots.reset(new int[(size_t)n * cells]);
+        for (int i = 0; i < n; i++) {
+            rng[i] = seed + (std::uint64_t)i * 0x632be59bd9b4e019ULL;
+            reset(i);
+        }
+        if (threads > 1) pool.reset(new WorkPool(threads));
+    }
+
+    int size() const { return n; }
+    int observationSize() const { return cells; }
+    // Ends an episode after this many ticks (0 = never), e.g. for agents
+    // that learn to loop forever.
+    void setTimeLimit(long ticksPerEpisode) { limit = ticksPerEpisode; }
+
+    int score(int i) const { return scores[i]; }
+    int finalScore(int i) const { return finals[i]; } // score of game i's last finished episode
+    int head(int i) const { return bodies[(size_t)i * cap + heads[i]]; }
+    int fruitCell(int i) const { return fruit[i]; }
+
+    // actions[i] is 0..3 for w, a, s, d; anything else (or a reversal) keeps
+    // going straight. rewards and dones must hold size() entries, obs (may be
+    // null) size() * observationSize() bytes.
+    void step(const std::int8_t* actions, float* rewards, std::uint8_t* dones, std::uint8_t* obs = nullptr) {
+        if (!pool) {
+            stepRange(0, n, actions, rewards, dones, obs);
+            return;
+        }
+        int chunks = (int)pool->size();
+        for (int c = 0; c < chunks; c++) {
+            int from = (int)((long long)n * c / chunks), to = (int)((long long)n * (c + 1) / chunks);
+            pool->submit([this, from, to, actions, rewards, dones, obs] { stepRange(from, to, actions, rewards, dones, obs); });
+        }
+        pool->wait();
+    }
+
+    // Observation of every game without stepping, e.g. after construction.
+    void observeAll(std::uint8_t* obs) const {
+        for (int i = 0; i < n; i++) observe(i, obs + (size_t)i * cells);
+    }
+};
+
+typedef BasicVecEnv<Board> VecEnv;
+
+#endif
@@ -0,0 +1,131 @@
+// === Work-Stealing Pool ===
+// Fixed set of worker threads, each with its own task deque. A worker takes
+// its newest task from the back of its own deque and, when that is empty,
+// steals the oldest task from the front of another worker's deque, so
+// uneven tasks (a long replay next to many short ones) still keep every
+// core busy. Tasks submitted from outside are spread round-robin; tasks
+// submitted from inside a worker go to that worker's own deque.
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "traceEvents.h"
+
+class WorkPool {
+    struct Worker {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<long> pending{0}; // submitted and not finished
+    std::atomic<long> queued{0};  // in a deque and not taken yet; raised under sleepLock
+    std::atomic<unsigned> nextWorker{0};
+    bool stopping = false; // under sleepLock
+    std::mutex sleepLock;
+    std::condition_variable wake, idle;
+
+    // Which pool and worker the calling thread belongs to, if any.
+    struct Slot {
+        const WorkPool* pool;
+        int index;
+    };
+    static Slot& current() {
+        thread_local Slot slot = {nullptr, -1};
+        return slot;
+    }
+
+    bool popOwn(int self, std::function<void()>& task) {
+        Worker& w = *workers[self];
+        std::lock_guard<std::mutex> guard(w.lock);
+        if (w.tasks.empty()) return false;
+        task = std::move(w.tasks.back());
+        w.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int self, std::function<void()>& task) {
+        int n = (int)workers.size();
+        for (int i = 1; i < n; i++) {
+            Worker& w = *workers[(self + i) % n];
+            std::lock_guard<std::mutex> guard(w.lock);
+            if (w.tasks.empty()) continue;
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void run(int self) {
+        current() = Slot{this, self};
+        TRACE_THREAD("worker");
+        std::function<void()> task;
+        for (;;) {
+            if (popOwn(self, task) || steal(self, task)) {
+                queued--;
+                task();
+                task = nullptr;
+                if (pending.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> guard(sleepLock);
+                    idle.notify_all();
+                }
+                continue;
+            }
+            // submit() raises queued under the same lock before notifying,
+            // so a task cannot slip in between this check and going to sleep.
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this] { return stopping || queued.load() > 0; });
+            if (stopping) return;
+        }
+    }
+
+public:
+    explicit WorkPool(unsigned count = std::thread::hardware_concurrency()) {
+        if (count == 0) count = 1;
+        for (unsigned i = 0; i < count; i++) workers.emplace_back(new Worker);
+        for (unsigned i = 0; i < count; i++) threads.emplace_back(&WorkPool::run, this, (int)i);
+    }
+
+    ~WorkPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : threads) t.join();
+    }
+
+    unsigned size() const { return (unsigned)workers.size(); }
+
+    void submit(std::function<void()> task) {
+        int target = current().pool == this ? current().index : (int)(nextWorker++ % workers.size());
+        pending++;
+        {
+            std::lock_guard<std::mutex> guard(workers[target]->lock);
+            workers[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    // Blocks until every submitted task has finished. Call from outside the pool.
+    void wait() {
+        std::unique_lock<std::mutex> guard(sleepLock);
+        idle.wait(guard, [this] { return pending.load() == 0; });
+    }
+};
+
+#endif